@@ -44,6 +44,7 @@ constexpr unsigned MAX_COMPLETIONS{MAX_OUTSTANDING_IO}; // how many completions
 
 static constexpr int max_batch_iocb_count = 4;
 static constexpr int max_batch_iov_cnt = IOV_MAX;
+static constexpr int inline_iov_cnt = 4; // iovs carried within the iocb, larger vectors are taken from the iov arena
 
 #ifdef __linux__
 struct iocb_info_t : public iocb {
@@ -53,9 +54,12 @@ struct iocb_info_t : public iocb {
     uint64_t offset;
     int fd;
     iovec* iov_ptr = nullptr;
-    iovec iovs[max_batch_iov_cnt];
+    iovec iovs[inline_iov_cnt];
     int iovcnt;
+    int rw_flags = 0; // RWF_* flags of the io, RWF_DSYNC for durable writes
     uint32_t resubmit_cnt = 0;
+    drive_iocb::io_done_fn_t done_fn{nullptr}; // Of the caller iocb, if the io came through async_io()
+    io_deadline_hook< iocb_info_t > deadline_hook;
 
     std::string to_string() const {
         return fmt::format("is_read={}, size={}, offset={}, fd={}, iovcnt={}", is_read, size, offset, fd, iovcnt);
@@ -106,6 +110,12 @@ struct aio_thread_context {
     int ev_fd = 0;
     io_context_t ioctx = 0;
     std::stack< iocb_info_t* > iocb_free_list;
+    // Preallocated iocbs in one contiguous slab. Iocbs beyond these are allocated on demand and freed on completion
+    std::unique_ptr< iocb_info_t[] > iocb_slab;
+    uint32_t iocb_slab_cnt = 0;
+    // Arena of iov arrays of max_batch_iov_cnt entries, for the ios with more iovs than the iocb carries inline. It
+    // grows to the max number of such ios outstanding at a time and is reused from there on
+    std::stack< iovec* > large_iov_free_list;
     std::queue< iocb_info_t* > iocb_retry_list;
     iocb_batch_t cur_iocb_batch;
     bool timer_set = false;
@@ -114,6 +124,9 @@ struct aio_thread_context {
     uint64_t max_submitted_aio;
     std::shared_ptr< IODevice > ev_io_dev = nullptr; // fd info after registering with IOManager
     poll_cb_idx_t poll_cb_idx;
+    bool track_deadlines = false; // Set if io_deadline is enabled
+    io_deadline_tracker< iocb_info_t > deadline_tracker;
+    timer_handle_t deadline_timer = null_timer_handle;
 
     ~aio_thread_context() {
         if (ev_fd) { close(ev_fd); }
@@ -125,20 +138,26 @@ struct aio_thread_context {
             free_iocb((struct iocb*)info);
         }
 
-        while (!iocb_free_list.empty()) {
-            auto info = iocb_free_list.top();
-            delete info;
-            iocb_free_list.pop();
+        // Free list has only the slab iocbs, which go along with the slab
+        while (!large_iov_free_list.empty()) {
+            delete[] large_iov_free_list.top();
+            large_iov_free_list.pop();
         }
     }
 
     void iocb_info_prealloc(uint32_t count) {
+        iocb_slab = std::make_unique< iocb_info_t[] >(count);
+        iocb_slab_cnt = count;
         for (auto i = 0u; i < count; ++i) {
-            iocb_free_list.push(new iocb_info_t());
+            iocb_free_list.push(&iocb_slab[i]);
         }
         max_submitted_aio = count;
     }
 
+    bool is_slab_iocb(const iocb_info_t* info) const {
+        return (info >= iocb_slab.get()) && (info < iocb_slab.get() + iocb_slab_cnt);
+    }
+
     bool can_be_batched(int iovcnt) {
         return ((iovcnt <= max_batch_iov_cnt) && (cur_iocb_batch.n_iocbs < max_batch_iocb_count));
     }
@@ -154,16 +173,31 @@ struct aio_thread_context {
             info = new iocb_info_t();
             ++post_alloc_iocb;
         }
-        if (iovcnt > max_batch_iov_cnt) {
-            info->iov_ptr = new iovec[iovcnt];
-        } else {
+        info->deadline_hook.reset();
+        info->done_fn = DriveInterface::submitting_done_fn();
+        if (iovcnt <= inline_iov_cnt) {
             info->iov_ptr = info->iovs;
+        } else if (iovcnt <= max_batch_iov_cnt) {
+            if (large_iov_free_list.empty()) {
+                info->iov_ptr = new iovec[max_batch_iov_cnt];
+            } else {
+                info->iov_ptr = large_iov_free_list.top();
+                large_iov_free_list.pop();
+            }
+        } else {
+            info->iov_ptr = new iovec[iovcnt];
         }
         return info;
     }
 
     void dec_submitted_aio();
 
+    // Deadline of an io starts at its io_submit, not while it waits in the retry list for a slot. Io resubmitted on
+    // error keeps the deadline of its first submission
+    void track_deadline(iocb_info_t* info) {
+        if (track_deadlines && !info->deadline_hook.linked) { deadline_tracker.add(info); }
+    }
+
     void inc_submitted_aio(int count);
 
     void push_retry_list(struct iocb* iocb) { iocb_retry_list.push(static_cast< iocb_info_t* >(iocb)); }
@@ -179,9 +213,16 @@ struct aio_thread_context {
 
     void free_iocb(struct iocb* iocb) {
         auto info = static_cast< iocb_info_t* >(iocb);
-        if (info->iov_ptr != info->iovs) { delete (info->iov_ptr); }
+        deadline_tracker.remove(info);
+        if (info->iov_ptr != info->iovs) {
+            if (info->iovcnt <= max_batch_iov_cnt) {
+                large_iov_free_list.push(info->iov_ptr);
+            } else {
+                delete[] info->iov_ptr;
+            }
+        }
         info->iov_ptr = nullptr;
-        if (post_alloc_iocb == 0) {
+        if (is_slab_iocb(info)) {
             iocb_free_list.push(info);
         } else {
             --post_alloc_iocb;
@@ -205,6 +246,7 @@ struct aio_thread_context {
                 io_prep_pwritev(iocb, info->fd, info->iov_ptr, info->iovcnt, info->offset);
             }
         }
+        iocb->aio_rw_flags = info->rw_flags; // io_prep_* resets the iocb
         io_set_eventfd(iocb, ev_fd);
         iocb->data = cookie;
     }
@@ -218,6 +260,7 @@ struct aio_thread_context {
         i_info->offset = offset;
         i_info->fd = fd;
         i_info->iovcnt = 0;
+        i_info->rw_flags = 0;
 
         struct iocb* iocb = static_cast< struct iocb* >(i_info);
         (is_read) ? io_prep_pread(iocb, fd, (void*)data, size, offset)
@@ -234,7 +277,7 @@ struct aio_thread_context {
     }
 
     struct iocb* prep_iocb_v(bool batch_io, int fd, bool is_read, const iovec* iov, int iovcnt, uint32_t size,
-                             uint64_t offset, uint8_t* cookie) {
+                             uint64_t offset, uint8_t* cookie, int rw_flags = 0) {
         auto i_info = alloc_iocb(iovcnt);
 
         i_info->is_read = is_read;
@@ -243,6 +286,7 @@ struct aio_thread_context {
         i_info->offset = offset;
         i_info->fd = fd;
         i_info->iovcnt = iovcnt;
+        i_info->rw_flags = rw_flags;
         memcpy(&i_info->iov_ptr[0], iov, sizeof(iovec) * iovcnt);
         iov = i_info->iov_ptr;
 
@@ -254,6 +298,7 @@ struct aio_thread_context {
             LOGTRACE("cur_iocb_batch.n_iocbs = {} ", cur_iocb_batch.n_iocbs);
         }
         (is_read) ? io_prep_preadv(iocb, fd, iov, iovcnt, offset) : io_prep_pwritev(iocb, fd, iov, iovcnt, offset);
+        iocb->aio_rw_flags = rw_flags;
         io_set_eventfd(iocb, ev_fd);
         iocb->data = cookie;
 
@@ -286,6 +331,9 @@ public:
 
         REGISTER_COUNTER(total_io_callbacks, "Number of times aio returned io events");
         REGISTER_COUNTER(resubmit_io_on_err, "number of times ios are resubmitted");
+        REGISTER_COUNTER(io_timeouts, "number of ios outstanding beyond the io timeout");
+        REGISTER_COUNTER(io_cancel_failures, "number of timed out ios which could not be cancelled");
+        REGISTER_HISTOGRAM(stuck_io_duration_ms, "Time taken by the ios which exceeded the io timeout to complete");
         register_me_to_farm();
     }
 
@@ -306,6 +354,8 @@ public:
                      bool part_of_batch = false) override;
     void async_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
                       bool part_of_batch = false) override;
+    void async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
+                              uint8_t* cookie, bool part_of_batch = false) override;
     void async_read(IODevice* iodev, char* data, uint32_t size, uint64_t offset, uint8_t* cookie,
                     bool part_of_batch = false) override;
     void async_readv(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
@@ -314,7 +364,7 @@ public:
                      bool part_of_batch = false) override;
     void fsync(IODevice* iodev, uint8_t* cookie) override {
         // LOGMSG_ASSERT(false, "fsync on aio drive interface is not supported");
-        if (m_comp_cb) m_comp_cb(0, cookie);
+        io_done(submitting_done_fn(), 0, cookie);
     }
     virtual void submit_batch() override;
 
@@ -329,6 +379,8 @@ private:
     void clear_iodev_thread_ctx(const io_device_ptr& iodev, const io_thread_t& thr) override {}
 
     void handle_completions();
+    void submit_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
+                       bool part_of_batch, int rw_flags);
 
     /* return true if it queues io.
      * return false if it do completion callback for error.
@@ -337,6 +389,9 @@ private:
     void retry_io();
     void push_retry_list(struct iocb* iocb, const bool no_slot);
     bool resubmit_iocb_on_err(struct iocb* iocb);
+    void check_io_deadlines();
+    bool cancel_io(iocb_info_t* info);
+    void complete_iocb(struct iocb* iocb, int64_t res);
 
 private:
     static thread_local aio_thread_context* t_aio_ctx;
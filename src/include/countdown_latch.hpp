@@ -0,0 +1,80 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+extern "C" {
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+namespace iomgr {
+/**
+ * @brief Lock free countdown latch. Count is kept in an atomic along with a "waiter present" bit (lowest bit), so
+ * that count_up/count_down is a single atomic instruction and the futex wake syscall is issued only when someone is
+ * actually sleeping on it. Count is allowed to go temporarily negative (count_down before count_up), wait() returns
+ * once it is exactly 0.
+ *
+ * After the count reaches 0, count_down touches nothing but the futex address, so the waiter is free to destroy the
+ * latch as soon as wait() returns.
+ */
+class countdown_latch {
+public:
+    countdown_latch(int32_t count = 0) : m_word{count * count_unit} {}
+    countdown_latch(const countdown_latch&) = delete;
+    countdown_latch& operator=(const countdown_latch&) = delete;
+
+    void count_up(int32_t n = 1) { m_word.fetch_add(n * count_unit, std::memory_order_relaxed); }
+
+    void count_down(int32_t n = 1) {
+        const auto prev{m_word.fetch_sub(n * count_unit, std::memory_order_acq_rel)};
+        if ((to_count(prev) == n) && (prev & waiter_bit)) { futex(FUTEX_WAKE_PRIVATE, INT_MAX); }
+    }
+
+    int32_t count() const { return to_count(m_word.load(std::memory_order_acquire)); }
+
+    void wait() {
+        auto cur{m_word.load(std::memory_order_acquire)};
+        while (to_count(cur) != 0) {
+            if (!(cur & waiter_bit)) {
+                // Announce the waiter before sleeping, so that the last count_down issues the wake
+                cur = m_word.fetch_or(waiter_bit, std::memory_order_acq_rel) | waiter_bit;
+                continue;
+            }
+            futex(FUTEX_WAIT_PRIVATE, cur);
+            cur = m_word.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    static constexpr int32_t waiter_bit{0x1};
+    static constexpr int32_t count_unit{0x2};
+    static_assert(sizeof(std::atomic< int32_t >) == sizeof(int32_t) && std::atomic< int32_t >::is_always_lock_free,
+                  "Futex requires atomic int to be layed out as plain int");
+
+    static int32_t to_count(int32_t word) { return (word >> 1); } // Arithmetic shift keeps negative counts
+
+    void futex(int op, int32_t val) {
+        ::syscall(SYS_futex, reinterpret_cast< int32_t* >(&m_word), op, val, nullptr, nullptr, 0);
+    }
+
+private:
+    std::atomic< int32_t > m_word;
+};
+} // namespace iomgr
@@ -23,6 +23,7 @@
 #include <unordered_map>
 #include <mutex>
 
+#include "io_deadline_tracker.hpp"
 #include "io_interface.hpp"
 #include "iomgr_types.hpp"
 
@@ -30,6 +31,10 @@ namespace iomgr {
 ENUM(drive_interface_type, uint8_t, aio, spdk, uring)
 ENUM(DriveOpType, uint8_t, WRITE, READ, UNMAP, WRITE_ZERO, FSYNC)
 
+// Called on the reactor which issued the io, once the io is outstanding beyond the io_deadline timeout. Cancel of the
+// io is attempted right after the callback and if it succeeds, io is completed with an error as usual.
+typedef std::function< void(uint8_t* cookie, uint64_t outstanding_ms) > io_timeout_cb_t;
+
 struct drive_attributes {
     uint32_t phys_page_size{4096};        // Physical page size of flash ssd/nvme. This is optimal size to do IO
     uint32_t align_size{0};               // size alignment supported by drives/kernel
@@ -60,21 +65,50 @@ struct drive_iocb {
     static constexpr int inlined_iov_count = 4;
     typedef std::array< iovec, inlined_iov_count > inline_iov_array;
     typedef std::unique_ptr< iovec[] > large_iov_array;
+    typedef void (*io_done_fn_t)(int64_t res, uint8_t* cookie);
 
+    // op_start_time is not stamped here, so that the submission doesn't need a clock read. Interfaces which need it
+    // (spdk) stamp it themselves.
     drive_iocb(IODevice* iodev, DriveOpType op_type, uint64_t size, uint64_t offset, void* cookie) :
             iodev(iodev), op_type(op_type), size(size), offset(offset), user_cookie(cookie) {
 #ifndef NDEBUG
         iocb_id = _iocb_id_counter.fetch_add(1, std::memory_order_relaxed);
 #endif
-        user_data.emplace< 0 >();
-        op_start_time = Clock::now();
     }
 
+    // For an iocb owned by the caller (say embedded in its request), which is prepared for every io through
+    // prepare() and submitted by DriveInterface::async_io()
+    drive_iocb() = default;
+
     virtual ~drive_iocb() = default;
 
+    // Reset the iocb for the next io, keeping the memory of the iovs (if any) around
+    void prepare(IODevice* dev, DriveOpType type, uint64_t sz, uint64_t off, void* cookie) {
+        iodev = dev;
+        op_type = type;
+        size = sz;
+        offset = off;
+        user_cookie = cookie;
+        iovcnt = 0;
+        result = -1;
+        sync_io_completed = false;
+        resubmit_cnt = 0;
+        part_read_resubmit_cnt = 0;
+        durable = false;
+        done_fn = nullptr;
+        deadline_hook.reset();
+#ifndef NDEBUG
+        iocb_id = _iocb_id_counter.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
     void set_iovs(const iovec* iovs, const int count) {
         iovcnt = count;
-        if (count > inlined_iov_count) { user_data = std::unique_ptr< iovec[] >(new iovec[count]); }
+        if (count > inlined_iov_count) {
+            user_data = std::unique_ptr< iovec[] >(new iovec[count]);
+        } else if (std::holds_alternative< char* >(user_data)) {
+            user_data.emplace< inline_iov_array >();
+        }
         std::memcpy(reinterpret_cast< void* >(get_iovs()), reinterpret_cast< const void* >(iovs),
                     count * sizeof(iovec));
     }
@@ -93,11 +127,20 @@ struct drive_iocb {
     }
 
     char* get_data() const { return std::get< char* >(user_data); }
+    bool is_rw() const { return (op_type == DriveOpType::READ) || (op_type == DriveOpType::WRITE); }
     bool has_iovs() const { return !std::holds_alternative< char* >(user_data); }
 
     void update_iovs_on_partial_result() {
         DEBUG_ASSERT_EQ(op_type, DriveOpType::READ, "Only expecting READ op for be returned with partial results.");
 
+        if (!has_iovs()) {
+            // Single buffer, resume right after the part which is read
+            user_data = get_data() + result;
+            size -= result;
+            offset += result;
+            return;
+        }
+
         const auto iovs = get_iovs();
         uint32_t num_iovs_unset{1};
         uint64_t remaining_iov_len{0}, size_unset{size - result};
@@ -160,21 +203,25 @@ struct drive_iocb {
         return str;
     }
 
-    IODevice* iodev;
-    DriveOpType op_type;
-    uint64_t size;
-    uint64_t offset;
+    IODevice* iodev{nullptr};
+    DriveOpType op_type{DriveOpType::READ};
+    uint64_t size{0};
+    uint64_t offset{0};
     void* user_cookie = nullptr;
     int iovcnt = 0;
     int64_t result{-1};
     bool sync_io_completed{false};
     uint32_t resubmit_cnt{0};
     uint32_t part_read_resubmit_cnt{0}; // only valid for uring interface
+    bool durable{false};                // Write is completed only after it reaches stable media
+    bool caller_owned{false};           // Submitted through async_io(), interface doesn't free it on completion
+    io_done_fn_t done_fn{nullptr};      // Called on completion instead of the interface completion callback
 #ifndef NDEBUG
-    uint64_t iocb_id;
+    uint64_t iocb_id{0};
 #endif
     Clock::time_point op_start_time;
     Clock::time_point op_submit_time;
+    io_deadline_hook< drive_iocb > deadline_hook;
 
 private:
     // Inline or additional memory
@@ -193,6 +240,10 @@ public:
                              bool part_of_batch = false) = 0;
     virtual void async_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
                               uint8_t* cookie, bool part_of_batch = false) = 0;
+    // Write which completes only once the data is on stable media, i.e. write followed by fsync but in one io
+    // (RWF_DSYNC write on kernel drives, write chained with a flush on spdk), saving a round trip on commit path
+    virtual void async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
+                                      uint8_t* cookie, bool part_of_batch = false) = 0;
     virtual void async_read(IODevice* iodev, char* data, uint32_t size, uint64_t offset, uint8_t* cookie,
                             bool part_of_batch = false) = 0;
     virtual void async_readv(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
@@ -207,7 +258,16 @@ public:
     virtual void write_zero(IODevice* iodev, uint64_t size, uint64_t offset, uint8_t* cookie) = 0;
     virtual void fsync(IODevice* iodev, uint8_t* cookie) = 0;
 
+    // Submit an io on the iocb owned by the caller. Iocb is prepared by the caller (prepare() and set_data()/set_iovs(),
+    // optionally done_fn) and must stay untouched till the completion, which goes to iocb->done_fn if set, else to the
+    // completion callback of the interface, with its user_cookie either way.
+    // NOTE: Only the uring interface issues the io on the caller iocb itself and so allocates nothing for it. Others
+    // (aio, spdk) submit it as the regular async io, which allocates an iocb of their own as usual and carries the
+    // done_fn along.
+    virtual void async_io(drive_iocb* iocb, bool part_of_batch = false);
+
     virtual void attach_completion_cb(const io_interface_comp_cb_t& cb) { m_comp_cb = cb; }
+    void attach_io_timeout_cb(const io_timeout_cb_t& cb) { m_io_timeout_cb = cb; }
 
     static drive_attributes get_attributes(const std::string& dev_name);
     static drive_type get_drive_type(const std::string& dev_name);
@@ -217,16 +277,32 @@ public:
     static std::shared_ptr< DriveInterface > get_iface_for_drive(const std::string& dev_name, const drive_type dtype);
     static size_t get_size(IODevice* iodev);
 
+    // done_fn of the io being submitted through async_io() on this thread, for the interfaces which submit it on an
+    // iocb of their own, to pick it up while creating that iocb
+    static drive_iocb::io_done_fn_t submitting_done_fn() { return t_submitting_done_fn; }
+
 protected:
     virtual size_t get_dev_size(IODevice* iodev) = 0;
     virtual drive_attributes get_attributes(const std::string& devname, const drive_type drive_type) = 0;
     virtual io_device_ptr open_dev(const std::string& dev_name, drive_type dev_type, int oflags) = 0;
 
+    // Complete the io to whoever waits for it, its own done_fn if it has one, else the interface completion callback
+    void io_done(drive_iocb::io_done_fn_t done_fn, int64_t res, uint8_t* cookie) const {
+        if (done_fn) {
+            done_fn(res, cookie);
+        } else if (m_comp_cb) {
+            m_comp_cb(res, cookie);
+        }
+    }
+
     io_interface_comp_cb_t m_comp_cb;
+    io_timeout_cb_t m_io_timeout_cb;
 
 private:
     static drive_type detect_drive_type(const std::string& dev_name);
 
+    static thread_local drive_iocb::io_done_fn_t t_submitting_done_fn;
+
 private:
     static std::unordered_map< std::string, drive_type > s_dev_type;
     static std::mutex s_dev_type_lookup_mtx;
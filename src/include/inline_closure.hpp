@@ -0,0 +1,188 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <sisl/logging/logging.h>
+
+namespace iomgr {
+template < typename Signature, size_t InlineSize >
+class inline_closure;
+
+/**
+ * @brief Type erased callable, similar to std::function, but with a fixed size inline storage large enough for the
+ * common lambda captures. Callables which fit in the inline storage are never heap allocated. Bigger ones (or the
+ * ones which can throw on move) fall back to heap. Callers which want to guarantee no allocation can check it at
+ * compile time with static_assert(inline_closure< ... >::fits_inline< F >).
+ *
+ * The closure can hold move-only callables as well, however copying such a closure is a fatal error.
+ *
+ * Callables which are invocable as const (non mutable lambdas, functors with const call operator) are invoked as
+ * const, see is_const_invocable(). Only such closures are safe to be invoked by multiple threads at the same time.
+ */
+template < typename R, typename... Args, size_t InlineSize >
+class inline_closure< R(Args...), InlineSize > {
+public:
+    static constexpr size_t inline_size{InlineSize};
+
+    template < typename F >
+    static constexpr bool fits_inline = (sizeof(F) <= InlineSize) && (alignof(F) <= alignof(std::max_align_t)) &&
+        std::is_nothrow_move_constructible_v< F >;
+
+    inline_closure() noexcept = default;
+    inline_closure(std::nullptr_t) noexcept {}
+
+    template < typename F, typename FT = std::decay_t< F >,
+               typename = std::enable_if_t< !std::is_same_v< FT, inline_closure > &&
+                                            std::is_invocable_r_v< R, FT&, Args... > > >
+    inline_closure(F&& f) {
+        if constexpr (fits_inline< FT >) {
+            ::new (static_cast< void* >(m_storage)) FT(std::forward< F >(f));
+            m_ops = &inline_ops< FT >::table;
+        } else {
+            *reinterpret_cast< FT** >(m_storage) = new FT(std::forward< F >(f));
+            m_ops = &heap_ops< FT >::table;
+        }
+    }
+
+    inline_closure(const inline_closure& other) {
+        if (other.m_ops) {
+            RELEASE_ASSERT(other.m_ops->copy, "Attempt to copy a closure holding a move-only callable");
+            other.m_ops->copy(other.m_storage, m_storage);
+            m_ops = other.m_ops;
+        }
+    }
+
+    inline_closure(inline_closure&& other) noexcept {
+        if (other.m_ops) {
+            other.m_ops->move(other.m_storage, m_storage);
+            m_ops = std::exchange(other.m_ops, nullptr);
+        }
+    }
+
+    inline_closure& operator=(const inline_closure& other) {
+        if (this != &other) {
+            inline_closure tmp{other};
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    inline_closure& operator=(inline_closure&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.m_ops) {
+                other.m_ops->move(other.m_storage, m_storage);
+                m_ops = std::exchange(other.m_ops, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    inline_closure& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~inline_closure() { reset(); }
+
+    // Callable which is not const invocable is invoked as non const, so a closure holding it must not be invoked by
+    // multiple threads at the same time
+    R operator()(Args... args) const {
+        if (!m_ops) { throw std::bad_function_call(); }
+        return m_ops->invoke(const_cast< unsigned char* >(m_storage), std::forward< Args >(args)...);
+    }
+
+    explicit operator bool() const noexcept { return (m_ops != nullptr); }
+    bool is_inline() const noexcept { return (m_ops != nullptr) && !m_ops->on_heap; }
+    bool is_const_invocable() const noexcept { return (m_ops != nullptr) && m_ops->const_invocable; }
+
+private:
+    using copy_fn_t = void (*)(const void*, void*);
+
+    struct ops_t {
+        R (*invoke)(void*, Args&&...);
+        copy_fn_t copy; // nullptr if callable is move-only
+        void (*move)(void*, void*) noexcept;
+        void (*destroy)(void*) noexcept;
+        bool on_heap;
+        bool const_invocable;
+    };
+
+    template < typename F >
+    static constexpr copy_fn_t copier(copy_fn_t fn) {
+        return std::is_copy_constructible_v< F > ? fn : nullptr;
+    }
+
+    template < typename F >
+    static constexpr bool const_invocable = std::is_invocable_r_v< R, const F&, Args... >;
+
+    template < typename F >
+    static R invoke_fn(F* f, Args&&... args) {
+        if constexpr (const_invocable< F >) {
+            return std::invoke(*static_cast< const F* >(f), std::forward< Args >(args)...);
+        } else {
+            return std::invoke(*f, std::forward< Args >(args)...);
+        }
+    }
+
+    template < typename F >
+    struct inline_ops {
+        static R invoke(void* s, Args&&... args) {
+            return invoke_fn(static_cast< F* >(s), std::forward< Args >(args)...);
+        }
+        static void copy(const void* src, void* dst) {
+            if constexpr (std::is_copy_constructible_v< F >) { ::new (dst) F(*static_cast< const F* >(src)); }
+        }
+        static void move(void* src, void* dst) noexcept {
+            ::new (dst) F(std::move(*static_cast< F* >(src)));
+            static_cast< F* >(src)->~F();
+        }
+        static void destroy(void* s) noexcept { static_cast< F* >(s)->~F(); }
+        static constexpr ops_t table{&invoke, copier< F >(&copy), &move, &destroy, false, const_invocable< F >};
+    };
+
+    template < typename F >
+    struct heap_ops {
+        static F* ptr(const void* s) { return *static_cast< F* const* >(s); }
+        static R invoke(void* s, Args&&... args) { return invoke_fn(ptr(s), std::forward< Args >(args)...); }
+        static void copy(const void* src, void* dst) {
+            if constexpr (std::is_copy_constructible_v< F >) { *static_cast< F** >(dst) = new F(*ptr(src)); }
+        }
+        static void move(void* src, void* dst) noexcept {
+            *static_cast< F** >(dst) = ptr(src);
+            *static_cast< F** >(src) = nullptr;
+        }
+        static void destroy(void* s) noexcept { delete ptr(s); }
+        static constexpr ops_t table{&invoke, copier< F >(&copy), &move, &destroy, true, const_invocable< F >};
+    };
+
+    void reset() noexcept {
+        if (m_ops) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+    const ops_t* m_ops{nullptr};
+};
+} // namespace iomgr
@@ -0,0 +1,134 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace iomgr {
+/**
+ * @brief Hook to be embedded (as member deadline_hook) in the io control block which is to be tracked by the
+ * io_deadline_tracker.
+ */
+template < typename T >
+struct io_deadline_hook {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point submit_time;
+    T* prev{nullptr};
+    T* next{nullptr};
+    bool linked{false};
+    bool timed_out{false};
+
+    void reset() {
+        prev = next = nullptr;
+        linked = timed_out = false;
+    }
+};
+
+/**
+ * @brief Per reactor tracker of the outstanding ios which exceed a timeout. It is intended to be owned by the thread
+ * context of a drive interface and as such is not thread safe, nor does it need to be.
+ *
+ * Every io is given the same timeout, so the order of submission is the order of deadlines and a plain intrusive
+ * FIFO list serves as the deadline queue: add() appends to the tail, remove() unlinks from anywhere and
+ * pop_expired() looks only at the head. All of them are O(1) and do not allocate. An io which is popped as expired is
+ * moved to a second list, so that it is reported only once and is not looked at again by the subsequent scans, while
+ * it still waits for its completion (or cancellation) to be removed.
+ */
+template < typename T >
+class io_deadline_tracker {
+public:
+    using Clock = typename io_deadline_hook< T >::Clock;
+
+    io_deadline_tracker() = default;
+    io_deadline_tracker(const io_deadline_tracker&) = delete;
+    io_deadline_tracker& operator=(const io_deadline_tracker&) = delete;
+
+    void add(T* io, typename Clock::time_point now = Clock::now()) {
+        auto& h{io->deadline_hook};
+        h.reset();
+        h.submit_time = now;
+        h.linked = true;
+        m_pending.push_back(io);
+        ++m_count;
+    }
+
+    // Returns how long (in ms) the io was outstanding if it had timed out earlier, 0 otherwise
+    uint64_t remove(T* io) {
+        auto& h{io->deadline_hook};
+        if (!h.linked) { return 0; }
+
+        (h.timed_out ? m_expired : m_pending).unlink(io);
+        h.linked = false;
+        --m_count;
+        return h.timed_out
+            ? std::chrono::duration_cast< std::chrono::milliseconds >(Clock::now() - h.submit_time).count()
+            : 0;
+    }
+
+    // Returns the oldest io which was submitted at or before the expiry cutoff, after marking it timed out. Returns
+    // nullptr if no io has expired
+    T* pop_expired(typename Clock::time_point cutoff) {
+        T* io{m_pending.head};
+        if ((io == nullptr) || (io->deadline_hook.submit_time > cutoff)) { return nullptr; }
+
+        m_pending.unlink(io);
+        io->deadline_hook.timed_out = true;
+        m_expired.push_back(io);
+        return io;
+    }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return (m_count == 0); }
+
+private:
+    struct io_list {
+        T* head{nullptr};
+        T* tail{nullptr};
+
+        void push_back(T* io) {
+            auto& h{io->deadline_hook};
+            h.prev = tail;
+            h.next = nullptr;
+            if (tail) {
+                tail->deadline_hook.next = io;
+            } else {
+                head = io;
+            }
+            tail = io;
+        }
+
+        void unlink(T* io) {
+            auto& h{io->deadline_hook};
+            if (h.prev) {
+                h.prev->deadline_hook.next = h.next;
+            } else {
+                head = h.next;
+            }
+            if (h.next) {
+                h.next->deadline_hook.prev = h.prev;
+            } else {
+                tail = h.prev;
+            }
+            h.prev = h.next = nullptr;
+        }
+    };
+
+    io_list m_pending;
+    io_list m_expired;
+    size_t m_count{0};
+};
+} // namespace iomgr
@@ -0,0 +1,96 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/uio.h>
+
+namespace iomgr {
+/**
+ * @brief Arena of io buffers which is registered once with every io_uring ring (fixed buffers), so that the ios on
+ * these buffers are issued as READ_FIXED/WRITE_FIXED and kernel doesn't pin/unpin the user pages for every io.
+ *
+ * The arena is one contiguous mapping, which is handed out in chunks of chunk_size to power of 2 size classes from
+ * min_buf_size to max_buf_size, on demand. A chunk once given to a class stays with it. Each class keeps its free
+ * buffers in a lock free stack, whose link is kept in the free buffer itself, so alloc and free are a CAS each.
+ * Buffers are aligned to their size class. Alloc returns nullptr if the size doesn't fit a class or the arena is
+ * exhausted, caller is expected to fall back to the regular allocator then.
+ */
+class iobuf_arena {
+public:
+    static constexpr size_t min_buf_size{4096};
+    static constexpr size_t max_buf_size{1024 * 1024};
+    static constexpr size_t chunk_size{2 * 1024 * 1024};
+    static constexpr uint32_t max_registered_mb{1024}; // Kernel limit on the size of a registered buffer
+
+    explicit iobuf_arena(size_t size);
+    ~iobuf_arena();
+    iobuf_arena(const iobuf_arena&) = delete;
+    iobuf_arena& operator=(const iobuf_arena&) = delete;
+
+    uint8_t* alloc(size_t align, size_t size);
+    void free(uint8_t* buf);
+
+    bool owns(const void* buf) const {
+        return (static_cast< const uint8_t* >(buf) >= m_base) && (static_cast< const uint8_t* >(buf) < m_end);
+    }
+    bool owns(const void* buf, size_t len) const {
+        return owns(buf) && (len <= static_cast< size_t >(m_end - static_cast< const uint8_t* >(buf)));
+    }
+
+    // Size of the buffer allocated from the arena (rounded up to its size class)
+    size_t buf_size(const uint8_t* buf) const;
+
+    // Whole arena as one iovec, to be registered with the ring. As such every fixed io uses buffer index 0
+    const iovec& iov() const { return m_iov; }
+    size_t size() const { return m_iov.iov_len; }
+
+private:
+    static constexpr size_t class_ratio{max_buf_size / min_buf_size};
+    static_assert((max_buf_size % min_buf_size == 0) && ((class_ratio & (class_ratio - 1)) == 0),
+                  "Size classes are powers of 2 from min_buf_size to max_buf_size");
+    static constexpr uint32_t num_classes{static_cast< uint32_t >(__builtin_ctzll(class_ratio)) + 1}; // 4K ... 1M
+    static constexpr uint32_t invalid_class{UINT8_MAX};
+    static constexpr uint32_t null_slot{UINT32_MAX};
+
+    static uint32_t size_class(size_t size);
+    static size_t class_size(uint32_t cls) { return min_buf_size << cls; }
+
+    uint32_t slot_of(const uint8_t* buf) const { return static_cast< uint32_t >((buf - m_base) / min_buf_size); }
+    uint8_t* buf_of(uint32_t slot) const { return m_base + (static_cast< size_t >(slot) * min_buf_size); }
+
+    void push(uint32_t cls, uint32_t first, uint32_t last);
+    uint32_t pop(uint32_t cls);
+    bool carve_chunk(uint32_t cls);
+
+private:
+    void* m_mapping{nullptr};
+    size_t m_mapping_size{0};
+    uint8_t* m_base{nullptr};
+    uint8_t* m_end{nullptr};
+    iovec m_iov{};
+
+    std::atomic< size_t > m_next_chunk{0};
+    size_t m_num_chunks{0};
+    std::unique_ptr< std::atomic< uint8_t >[] > m_chunk_class;
+
+    // Head of each class free stack: slot index in lower 32 bits, ABA tag in upper 32 bits
+    std::array< std::atomic< uint64_t >, num_classes > m_free_head;
+};
+} // namespace iomgr
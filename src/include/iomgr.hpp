@@ -50,12 +50,15 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "countdown_latch.hpp"
 #include "drive_interface.hpp"
 #include "io_interface.hpp"
+#include "iobuf_arena.hpp"
 #include "iomgr_msg.hpp"
 #include "iomgr_timer.hpp"
 #include "iomgr_types.hpp"
 #include "reactor.hpp"
+#include "reactor_selector.hpp"
 
 struct spdk_bdev_desc;
 struct spdk_bdev;
@@ -104,29 +107,22 @@ private:
 
 struct synchronized_async_method_ctx {
 public:
-    std::mutex m;
-    std::condition_variable cv;
-    ssize_t outstanding_count{0};
+    countdown_latch outstanding;
     void* custom_ctx{nullptr};
 
     ~synchronized_async_method_ctx() {
-        DEBUG_ASSERT_EQ(outstanding_count, 0, "Expecting no outstanding ref of method");
+        DEBUG_ASSERT_EQ(outstanding.count(), 0, "Expecting no outstanding ref of method");
     }
 
 private:
     static void done(void* arg, [[maybe_unused]] int rc) {
         synchronized_async_method_ctx* pmctx = static_cast< synchronized_async_method_ctx* >(arg);
-        {
-            std::unique_lock< std::mutex > lk{pmctx->m};
-            --pmctx->outstanding_count;
-        }
-        pmctx->cv.notify_one();
+        pmctx->outstanding.count_down();
     }
 
 public:
     auto get_done_cb() {
-        std::unique_lock< std::mutex > lk{m};
-        ++outstanding_count;
+        outstanding.count_up();
         return (synchronized_async_method_ctx::done);
     }
 };
@@ -136,11 +132,11 @@ public:
  */
 extern const version::Semver200_version get_version();
 
-class IOWatchDog;
 class IOManager {
 public:
     friend class IOReactor;
     friend class IOReactorEPoll;
+    friend class IOReactorUring;
     friend class IOReactorSPDK;
     friend class IOInterface;
     friend class DriveInterface;
@@ -276,10 +272,7 @@ public:
                const run_on_closure_t& cb_wait_closure = nullptr) {
         bool sent{false};
         if (wtype == wait_type_t::no_wait) {
-            // make rvalue copy of completion func
-            sent = send_msg(thread,
-                            iomgr_msg::create(iomgr_msg_type::RUN_METHOD, m_internal_msg_module_id,
-                                              std::remove_reference_t< std::remove_cv_t< decltype(fn) > >{fn}));
+            sent = send_msg(thread, iomgr_msg::create(iomgr_msg_type::RUN_METHOD, m_internal_msg_module_id, fn));
         } else if (wtype == wait_type_t::callback) {
             DEBUG_ASSERT(0, "run_on direct thread with async closure is not supported yet");
         } else if ((wtype == wait_type_t::spin) && IOManager::instance().am_i_io_reactor()) {
@@ -293,6 +286,41 @@ public:
         return (sent ? 1 : 0);
     }
 
+    /**
+     * @brief Run a batch of methods on a specific thread in the order they are provided. All methods are carried by
+     * a single message, so the destination is enqueued and woken up only once for the entire batch. It is useful
+     * when posting bursts of closures to the same thread.
+     *
+     * @param thread The IO Thread returned from the destination iothread_self() to which the methods are to run
+     * @param fns Methods to run
+     *
+     * @return Number of methods scheduled to run (either all or none)
+     */
+    int run_on_batch(const io_thread_t& thread, std::vector< run_method_t >&& fns) {
+        if (fns.empty()) { return 0; }
+        const auto count{static_cast< int >(fns.size())};
+        const bool sent{send_msg(thread,
+                                 iomgr_msg::create(iomgr_msg_type::RUN_METHOD, m_internal_msg_module_id,
+                                                   [fns = std::move(fns)](io_thread_addr_t taddr) {
+                                                       for (auto& fn : fns) {
+                                                           fn(taddr);
+                                                       }
+                                                   }))};
+        return (sent ? count : 0);
+    }
+
+    /**
+     * @brief Run a fire and forget method on any one of the worker threads. Method is queued up on the local worker
+     * (if caller is a worker thread) or handed to the least busy worker, but any idle worker can steal it from
+     * there and run it. It is meant for cpu bound closures, which don't care about the thread they run on, so that
+     * a long running closure on one worker doesn't stall the rest queued up behind it.
+     *
+     * @param fn Method to run
+     *
+     * @return 1 for able to schedule the method to run, 0 otherwise
+     */
+    int run_on_any_worker(run_method_t&& fn);
+
     /**
      * @brief Run the lambda/function passed on multipled threads and optionally wait for theirs completion. If the
      * caller is one among the destination thread, it will run the method right away in that thread.
@@ -361,18 +389,12 @@ public:
 
         const int executed_on{run_on(r, [&fn, ctx]([[maybe_unused]] auto taddr) {
             fn(*ctx);
-            {
-                std::unique_lock< std::mutex > lk{ctx->m};
-                --(ctx->outstanding_count);
-            }
-            ctx->cv.notify_one();
+            ctx->outstanding.count_down();
         })};
 
-        {
-            std::unique_lock< std::mutex > lk{ctx->m};
-            ctx->outstanding_count += executed_on;
-            ctx->cv.wait(lk, [ctx] { return (ctx->outstanding_count == 0); });
-        }
+        // Count could have gone negative if methods completed before this, latch is woken once it reaches 0
+        ctx->outstanding.count_up(executed_on);
+        ctx->outstanding.wait();
     }
 
     /********* Access related methods ***********/
@@ -412,6 +434,20 @@ public:
     [[nodiscard]] bool is_spdk_mode() const { return m_is_spdk; }
     [[nodiscard]] bool is_uring_capable() const { return m_is_uring_capable; }
 
+    // Arena of io buffers to be registered as fixed buffers, nullptr if not enabled
+    [[nodiscard]] iobuf_arena* fixed_buf_arena() const { return m_fixed_buf_arena.get(); }
+
+    // Stop allocating io buffers from the arena, once a ring fails to register it. Buffers already allocated from it
+    // are still freed to it, so the arena itself stays.
+    void disable_fixed_buf_arena();
+
+    /**
+     * @brief Set the policy to select a worker thread when messages are sent to thread_regex::least_busy_worker.
+     * Default is power_of_two (less loaded among 2 random workers).
+     */
+    void set_worker_select_policy(reactor_select_policy_t policy) { m_worker_selector.set_policy(policy); }
+    [[nodiscard]] reactor_select_policy_t worker_select_policy() const { return m_worker_selector.policy(); }
+
     /********* State Machine Related Operations ********/
     bool is_ready() const { return (get_state() == iomgr_state::running); }
 
@@ -462,6 +498,7 @@ public:
 
     /******** Message related infra ********/
     bool send_msg(const io_thread_t& thread, iomgr_msg* msg);
+    int send_msgs(const io_thread_t& thread, msg_batch_t&& msgs);
     bool send_msg_and_wait(const io_thread_t& thread, const std::shared_ptr< sync_msg_base >& smsg);
     int multicast_msg(thread_regex r, iomgr_msg* msg);
     int multicast_msg_and_wait(thread_regex r, const std::shared_ptr< sync_msg_base >& smsg);
@@ -476,6 +513,9 @@ public:
     void iobuf_pool_free(uint8_t* buf, size_t size, const sisl::buftag tag = sisl::buftag::common);
     uint8_t* iobuf_realloc(uint8_t* buf, size_t align, size_t new_size);
     size_t iobuf_size(uint8_t* buf) const;
+
+    // Limit applies to iobufs from the regular allocator. The fixed buf arena (if enabled) is a fixed size mapping
+    // on top of this limit and is not released on memory pressure.
     void set_io_memory_limit(size_t limit);
     [[nodiscard]] size_t soft_mem_threshold() const { return m_mem_soft_threshold_size; }
     [[nodiscard]] size_t aggressive_mem_threshold() const { return m_mem_aggressive_threshold_size; }
@@ -485,14 +525,19 @@ public:
                                          timer_callback_t&& timer_fn);
     timer_handle_t schedule_global_timer(uint64_t nanos_after, bool recurring, void* cookie, thread_regex r,
                                          timer_callback_t&& timer_fn, bool wait_to_schedule = false);
+
+    // Variants for timers which do not need precision. Timer could fire anywhere in [nanos_after, nanos_after +
+    // slack_nanos] and the ones falling in the same window are coalesced into one wakeup
+    timer_handle_t schedule_thread_timer(uint64_t nanos_after, uint64_t slack_nanos, bool recurring, void* cookie,
+                                         timer_callback_t&& timer_fn);
+    timer_handle_t schedule_global_timer(uint64_t nanos_after, uint64_t slack_nanos, bool recurring, void* cookie,
+                                         thread_regex r, timer_callback_t&& timer_fn, bool wait_to_schedule = false);
     void cancel_timer(timer_handle_t thdl, bool wait_to_cancel = false) {
         return thdl.first->cancel(thdl, wait_to_cancel);
     }
     void set_poll_interval(const int interval);
     int get_poll_interval() const;
 
-    IOWatchDog* get_io_wd() const { return m_io_wd.get(); };
-
     void drive_interface_submit_batch();
 
 private:
@@ -518,9 +563,12 @@ private:
     void register_mempool_metrics(struct rte_mempool* mp);
 
     void _pick_reactors(thread_regex r, const auto& cb);
+    bool can_share_msg(const iomgr_msg* msg) const;
     void all_reactors(const auto& cb);
     void specific_reactor(int thread_num, const auto& cb);
     IOReactor* round_robin_reactor() const;
+    void wake_task_thief(IOReactor* victim);
+    stealable_task* steal_task(IOReactor* thief);
 
     [[nodiscard]] bool is_spdk_inited() const;
 
@@ -550,6 +598,7 @@ private:
     std::vector< std::shared_ptr< IOReactor > > m_worker_reactors;
     std::vector< sys_thread_id_t > m_worker_threads;
     std::uniform_int_distribution< size_t > m_rand_worker_distribution;
+    ReactorSelector m_worker_selector; // Picks the worker reactor for least_busy_worker
 
     std::unique_ptr< timer_epoll > m_global_user_timer;
     std::unique_ptr< timer > m_global_worker_timer;
@@ -567,13 +616,14 @@ private:
 
     bool m_is_uring_capable{false};
     bool m_is_cpu_pinning_enabled{false};
+    std::unique_ptr< iobuf_arena > m_fixed_buf_arena;
+    std::atomic< bool > m_fixed_buf_arena_enabled{false};
 
     folly::Synchronized< std::unordered_map< std::string, IOMempoolMetrics > > m_mempool_metrics_set;
     size_t m_mem_size_limit{std::numeric_limits< size_t >::max()};
     size_t m_mem_soft_threshold_size{m_mem_size_limit};
     size_t m_mem_aggressive_threshold_size{m_mem_size_limit};
 
-    std::unique_ptr< IOWatchDog > m_io_wd{nullptr};
 };
 
 struct SpdkAlignedAllocImpl : public sisl::AlignedAllocatorImpl {
@@ -50,6 +50,26 @@ public:
                 authorization = SISL_OPTIONS["authorization"].as< bool >();
                 is_modified = true;
             }
+            auto& uring_reactor = s.uring->reactor_enabled;
+            if (SISL_OPTIONS.count("uring_reactor")) {
+                uring_reactor = SISL_OPTIONS["uring_reactor"].as< bool >();
+                is_modified = true;
+            }
+            auto& uring_sqpoll = s.uring->sqpoll_enabled;
+            if (SISL_OPTIONS.count("uring_sqpoll")) {
+                uring_sqpoll = SISL_OPTIONS["uring_sqpoll"].as< bool >();
+                is_modified = true;
+            }
+            auto& uring_plain_rw = s.uring->plain_rw_enabled;
+            if (SISL_OPTIONS.count("uring_plain_rw")) {
+                uring_plain_rw = SISL_OPTIONS["uring_plain_rw"].as< bool >();
+                is_modified = true;
+            }
+            auto& force_aio = s.aio->forced;
+            if (SISL_OPTIONS.count("force_aio")) {
+                force_aio = SISL_OPTIONS["force_aio"].as< bool >();
+                is_modified = true;
+            }
             // Any more default overrides or set non-scalar entries come here
         });
 
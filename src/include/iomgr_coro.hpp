@@ -0,0 +1,206 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+/*
+ * Coroutine wrappers over the callback based DriveInterface, run_on and timer APIs. The library itself is built as
+ * C++17, so this header is usable only by the consumers which compile with coroutine support (C++20); for everyone
+ * else it compiles to nothing.
+ *
+ * All awaiters keep their state inside the coroutine frame (the awaiter object itself is the cookie passed to the
+ * callback API), so an await does not allocate. For drive ios that holds on the interfaces which issue the io on the
+ * caller iocb, see DriveInterface::async_io(). Drive completions and thread timers fire on the reactor which issued
+ * them, so the coroutine is resumed inline from that completion, without any message hop.
+ */
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "drive_interface.hpp"
+#include "iomgr.hpp"
+
+namespace iomgr {
+/**
+ * @brief Return type of a fire and forget coroutine. It starts running right away on the calling thread and its
+ * frame is freed once it runs to completion. The coroutine frame is the only allocation made, once per coroutine.
+ */
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * @brief Awaiter for one drive IO. The io is issued through DriveInterface::async_io() on the iocb within the awaiter,
+ * whose done_fn resumes the coroutine. Completion callback attached to the drive is left alone, so the same drive
+ * interface can be shared with the callback based users.
+ */
+class drive_io_awaiter {
+public:
+    drive_io_awaiter(DriveInterface* drive, IODevice* iodev, DriveOpType op_type, uint32_t size, uint64_t offset) :
+            m_drive{drive} {
+        m_iocb.prepare(iodev, op_type, size, offset, nullptr);
+    }
+
+    drive_io_awaiter(DriveInterface* drive, IODevice* iodev, DriveOpType op_type, char* data, uint32_t size,
+                     uint64_t offset) :
+            drive_io_awaiter{drive, iodev, op_type, size, offset} {
+        m_iocb.set_data(data);
+    }
+
+    drive_io_awaiter(DriveInterface* drive, IODevice* iodev, DriveOpType op_type, const iovec* iov, int iovcnt,
+                     uint32_t size, uint64_t offset, bool durable = false) :
+            drive_io_awaiter{drive, iodev, op_type, size, offset} {
+        m_iocb.set_iovs(iov, iovcnt);
+        m_iocb.durable = durable;
+    }
+
+    drive_io_awaiter(const drive_io_awaiter&) = delete;
+    drive_io_awaiter& operator=(const drive_io_awaiter&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        m_handle = h;
+        m_iocb.user_cookie = this;
+        m_iocb.done_fn = &drive_io_awaiter::on_completion;
+        // Completion can resume (and even finish) the coroutine before the submit returns, so this awaiter should
+        // not be touched after this call.
+        m_drive->async_io(&m_iocb);
+    }
+    int64_t await_resume() const noexcept { return m_res; }
+
+private:
+    static void on_completion(int64_t res, uint8_t* cookie) {
+        auto* self{reinterpret_cast< drive_io_awaiter* >(cookie)};
+        self->m_res = res;
+        self->m_handle.resume();
+    }
+
+    DriveInterface* m_drive;
+    drive_iocb m_iocb;
+    std::coroutine_handle<> m_handle;
+    int64_t m_res{0};
+};
+
+/**
+ * @brief co_await co_read(drive, iodev, ...) issues the async read and resumes with the result of the io (0 on
+ * success, error otherwise).
+ */
+inline drive_io_awaiter co_read(DriveInterface* drive, IODevice* iodev, char* data, uint32_t size, uint64_t offset) {
+    return drive_io_awaiter{drive, iodev, DriveOpType::READ, data, size, offset};
+}
+
+inline drive_io_awaiter co_readv(DriveInterface* drive, IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size,
+                                 uint64_t offset) {
+    return drive_io_awaiter{drive, iodev, DriveOpType::READ, iov, iovcnt, size, offset};
+}
+
+inline drive_io_awaiter co_write(DriveInterface* drive, IODevice* iodev, const char* data, uint32_t size,
+                                 uint64_t offset) {
+    return drive_io_awaiter{drive, iodev, DriveOpType::WRITE, const_cast< char* >(data), size, offset};
+}
+
+inline drive_io_awaiter co_writev(DriveInterface* drive, IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size,
+                                  uint64_t offset) {
+    return drive_io_awaiter{drive, iodev, DriveOpType::WRITE, iov, iovcnt, size, offset};
+}
+
+inline drive_io_awaiter co_writev_durable(DriveInterface* drive, IODevice* iodev, const iovec* iov, int iovcnt,
+                                          uint32_t size, uint64_t offset) {
+    return drive_io_awaiter{drive, iodev, DriveOpType::WRITE, iov, iovcnt, size, offset, true /* durable */};
+}
+
+inline drive_io_awaiter co_unmap(DriveInterface* drive, IODevice* iodev, uint32_t size, uint64_t offset) {
+    return drive_io_awaiter{drive, iodev, DriveOpType::UNMAP, size, offset};
+}
+
+/**
+ * @brief Awaiter to run a method on another io thread and resume back on the awaiting thread once it is done. If
+ * the destination is the awaiting thread itself, method is run inline without suspending.
+ *
+ * co_await returns true if the method was run, false if it could not be sent to the destination thread (in which
+ * case the coroutine resumes right away on the awaiting thread).
+ */
+template < typename F >
+class run_on_awaiter {
+public:
+    run_on_awaiter(const io_thread_t& thread, F&& fn) : m_thread{thread}, m_fn{std::move(fn)} {}
+
+    bool await_ready() {
+        if (m_thread == iomanager.iothread_self()) {
+            m_fn();
+            m_ran = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        m_handle = h;
+        m_caller = iomanager.iothread_self();
+        // Only the awaiter address is captured, so both closures fit the msg inline storage
+        return (iomanager.run_on(m_thread, [this]([[maybe_unused]] auto taddr) {
+            m_fn();
+            m_ran = true;
+            iomanager.run_on(m_caller, [this]([[maybe_unused]] auto taddr) { m_handle.resume(); });
+        }) != 0);
+    }
+
+    bool await_resume() const noexcept { return m_ran; }
+
+private:
+    io_thread_t m_thread;
+    io_thread_t m_caller;
+    F m_fn;
+    bool m_ran{false};
+    std::coroutine_handle<> m_handle;
+};
+
+template < typename F >
+auto run_on_await(const io_thread_t& thread, F&& fn) {
+    return run_on_awaiter< std::decay_t< F > >{thread, std::forward< F >(fn)};
+}
+
+/**
+ * @brief Awaiter which suspends the coroutine for given nanoseconds using a thread timer of the awaiting reactor.
+ */
+class sleep_awaiter {
+public:
+    explicit sleep_awaiter(uint64_t nanos) : m_nanos{nanos} {}
+
+    bool await_ready() const noexcept { return (m_nanos == 0); }
+    void await_suspend(std::coroutine_handle<> h) {
+        m_handle = h;
+        // Captureless, so std::function holds it without allocation
+        iomanager.schedule_thread_timer(m_nanos, false /* recurring */, this, [](void* cookie) {
+            static_cast< sleep_awaiter* >(cookie)->m_handle.resume();
+        });
+    }
+    void await_resume() const noexcept {}
+
+private:
+    uint64_t m_nanos;
+    std::coroutine_handle<> m_handle;
+};
+
+inline sleep_awaiter sleep_for(uint64_t nanos) { return sleep_awaiter{nanos}; }
+} // namespace iomgr
+#endif
@@ -24,6 +24,8 @@
 #include <sisl/utility/obj_life_counter.hpp>
 #include "reactor.hpp"
 #include "iomgr_types.hpp"
+#include "countdown_latch.hpp"
+#include "msg_pool.hpp"
 
 namespace iomgr {
 
@@ -37,6 +39,7 @@ struct iomgr_msg_type {
     static constexpr int REMOVE_DEVICE = 5;        // Remove an iodevice to the io thread
 #endif
     static constexpr int RUN_METHOD = 6; // Run the method in your thread
+    static constexpr int MSG_BATCH = 7;  // Carrier of batch of messages to the same thread
 };
 
 ENUM(msg_direction_t, uint8_t,
@@ -60,21 +63,26 @@ struct sync_msg_base {
 };
 
 struct iomgr_msg : public sisl::ObjLifeCounter< iomgr_msg > {
-    friend class sisl::ObjectAllocator< iomgr_msg >;
-
     int m_type = 0;                    // Type of the message (different meaning for different modules)
     msg_module_id_t m_dest_module = 0; // Default to internal module
     io_thread_addr_t m_dest_thread;    // Where this message is headed to
     bool m_is_reply{false};
-    std::shared_ptr< sync_msg_base > m_sync_msg; // Backpointer to sync messages
+    bool m_is_broadcast{false};                          // Same msg is shared by all its destination threads
+    sisl::atomic_counter< int32_t > m_broadcast_refs{0}; // Destinations (+ sender) yet to complete a broadcast msg
+    std::shared_ptr< sync_msg_base > m_sync_msg;         // Backpointer to sync messages
     msg_data_t m_data;
 
+    // Messages come from msg_pool, whose blocks go back to the allocating (sender) thread, so that the senders of
+    // one way messages don't hit the system allocator for every message.
     template < class... Args >
     static iomgr_msg* create(Args&&... args) {
-        return sisl::ObjectAllocator< iomgr_msg >::make_object(std::forward< Args >(args)...);
+        return new (msg_pool< iomgr_msg >::alloc()) iomgr_msg(std::forward< Args >(args)...);
     }
 
-    static void free(iomgr_msg* msg) { sisl::ObjectAllocator< iomgr_msg >::deallocate(msg); }
+    static void free(iomgr_msg* msg) {
+        msg->~iomgr_msg();
+        msg_pool< iomgr_msg >::free(msg);
+    }
 
     static void completed(iomgr_msg* msg) {
         if (msg->m_sync_msg) {
@@ -87,13 +95,16 @@ struct iomgr_msg : public sisl::ObjLifeCounter< iomgr_msg > {
                 // Base msgs are freed by the sync_msg class. We need to free only cloned messages
                 if (cloned_msg) { iomgr_msg::free(msg); }
             }
+        } else if (msg->m_is_broadcast) {
+            // Broadcast msg is freed only after sender and every destination thread completed it
+            if (msg->m_broadcast_refs.decrement_testz()) { iomgr_msg::free(msg); }
         } else {
             iomgr_msg::free(msg);
         }
     }
 
     virtual iomgr_msg* clone() {
-        auto new_msg = sisl::ObjectAllocator< iomgr_msg >::make_object(m_type, m_dest_module, m_data);
+        auto new_msg = iomgr_msg::create(m_type, m_dest_module, m_data);
         new_msg->m_sync_msg = m_sync_msg;
         return new_msg;
     }
@@ -103,6 +114,7 @@ struct iomgr_msg : public sisl::ObjLifeCounter< iomgr_msg > {
     // iomgr_msg &operator=(const iomgr_msg &msg) = default;
     sisl::blob data_buf() const { return std::get< sisl::blob >(m_data); }
     const run_method_t& method_data() const { return std::get< run_method_t >(m_data); }
+    const msg_batch_t& batch_data() const { return std::get< msg_batch_t >(m_data); }
     const reschedule_data_t& schedule_data() const { return std::get< reschedule_data_t >(m_data); }
     const std::shared_ptr< IODevice >& iodevice_data() const { return schedule_data().iodev; }
     int event() const { return schedule_data().event; }
@@ -119,6 +131,8 @@ protected:
             m_type{type}, m_dest_module{module}, m_data{sisl::blob{(uint8_t*)buf, size}} {}
     iomgr_msg(int type, msg_module_id_t module, const std::shared_ptr< IODevice >& iodev, int event) :
             m_type{type}, m_dest_module{module}, m_data{reschedule_data_t{iodev, event}} {}
+    iomgr_msg(int type, msg_module_id_t module, msg_batch_t&& batch) :
+            m_type{type}, m_dest_module{module}, m_data{std::move(batch)} {}
     iomgr_msg(int type, msg_module_id_t module, const auto& fn) :
             m_type{type}, m_dest_module{module}, m_data{run_method_t{fn}} {}
 
@@ -128,13 +142,19 @@ protected:
     // iomgr_msg(int type, msg_module_id_t module, const auto& fn) :
     //        iomgr_msg(type, module, msg_data_t(run_method_t{fn})) {}
 
-    virtual ~iomgr_msg() = default;
+    virtual ~iomgr_msg() {
+        // Messages carried by a batch which were never handled (dropped or not delivered), are completed along
+        // with its carrier
+        if (auto batch = std::get_if< msg_batch_t >(&m_data)) {
+            for (auto& msg : *batch) {
+                completed(msg);
+            }
+        }
+    }
 };
 
 struct sync_iomgr_msg : public sync_msg_base {
-    mutable std::mutex m_mtx;
-    std::condition_variable m_cv;
-    int32_t m_pending{0};
+    countdown_latch m_pending;
 
 public:
     template < class... Args >
@@ -147,29 +167,10 @@ public:
 
     virtual ~sync_iomgr_msg() = default;
 
-    void set_pending() override {
-        std::lock_guard< std::mutex > lck(m_mtx);
-        ++m_pending;
-    }
-
-    int32_t num_pending() const override {
-        std::lock_guard< std::mutex > lck(m_mtx);
-        return m_pending;
-    }
-
-    void one_completion() override {
-        {
-            std::lock_guard< std::mutex > lck(m_mtx);
-            --m_pending;
-        }
-        m_cv.notify_one();
-    }
-
-    void wait() override {
-        std::unique_lock< std::mutex > lck(m_mtx);
-        m_cv.wait(lck, [this] { return (m_pending == 0); });
-    }
-
+    void set_pending() override { m_pending.count_up(); }
+    int32_t num_pending() const override { return m_pending.count(); }
+    void one_completion() override { m_pending.count_down(); }
+    void wait() override { m_pending.wait(); }
     void received_reply() override { assert(0); }
 
     bool sender_needed_iothread() const override { return false; }
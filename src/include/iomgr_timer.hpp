@@ -20,11 +20,10 @@
 #include <set>
 #include <boost/heap/binomial_heap.hpp>
 #include "iomgr_types.hpp"
+#include "timer_wheel.hpp"
 
 struct spdk_poller;
 namespace iomgr {
-typedef std::function< void(void*) > timer_callback_t;
-
 class timer;
 struct timer_info {
     std::chrono::steady_clock::time_point expiry_time;
@@ -86,7 +85,8 @@ class timer;
 struct IODevice;
 
 using timer_heap_t = boost::heap::binomial_heap< timer_info, boost::heap::compare< compare_timer > >;
-using timer_backing_handle_t = std::variant< timer_heap_t::handle_type, std::shared_ptr< IODevice >, spdk_timer_ptr >;
+using timer_backing_handle_t =
+    std::variant< timer_heap_t::handle_type, std::shared_ptr< IODevice >, spdk_timer_ptr, timer_wheel::handle_t >;
 using timer_handle_t = std::pair< timer*, timer_backing_handle_t >;
 // using timer_handle_t =
 //    std::variant< timer_heap_t::handle_type, std::shared_ptr< IODevice >, spdk_timer_info*, spdk_thread_timer_info* >;
@@ -103,15 +103,18 @@ static const timer_handle_t null_timer_handle = timer_handle_t(nullptr, std::sha
  * possible.
  *
  * Recurring: Timer that automatically recurs and called frequent interval until cancelled. This timer is generally
- * accurate provide the entire application is not completely swamped with CPU usage. It is almost a pass-through to
- * system level timer, wherein every time a recurring timer is created an timer fd is created and added to
- * corresponding epoll set (if per thread timer, added only to that thread's epoll set, global timer gets its timer
- * fd added to all threads).
+ * accurate provide the entire application is not completely swamped with CPU usage. With the timing wheel (default),
+ * it is re-inserted into the wheel upon every expiry and shares the common timer fd with non-recurring timers. If
+ * the wheel is disabled, it is almost a pass-through to system level timer, wherein every time a recurring timer is
+ * created an timer fd is created and added to corresponding epoll set (if per thread timer, added only to that
+ * thread's epoll set, global timer gets its timer fd added to all threads).
  *
  * Non-recurring: While non-recurring can technically work like recurring, where it can create timer fd everytime it
  * is created, it is expected that non-recurring will be called frequently (say for every IO to start a timer) and
  * doing this way is very expensive, since it needs to create fd add to epoll set etc (causing multiple expensive
- * system calls). Hence it is avoided by registering one common timer fd
+ * system calls). Hence it is avoided by registering one common timer fd. Epoll timer keeps the timers in a
+ * hierarchical timing wheel (O(1) schedule/cancel, lock free for per thread timers) and arms the common timer fd
+ * only for the earliest expiry. If the wheel is disabled in config, a binomial heap is used instead.
  */
 class timer {
 public:
@@ -126,12 +129,14 @@ public:
      * @param cookie Any cookie that needs to be passed into the timer function
      * @param timer_fn Callback to be called by the timeout routine
      * @param wait_to_schedule Wait for the schedule timer to be scheduled completely or it is done in async manner.
+     * @param slack_nanos Tolerance window after nanos_after, within which timer can be fired. Timers expiring within
+     * the window are coalesced into one wakeup. Honored only by the epoll timer with the timing wheel enabled.
      *
      * @return timer_handle_t Returns a handle which it needs to use to cancel the timer. In case of recurring
      * timer, the caller needs to call cancel, failing which causes a memory leak.
      */
     virtual timer_handle_t schedule(uint64_t nanos_after, bool recurring, void* cookie, timer_callback_t&& timer_fn,
-                                    bool wait_to_schedule = false) = 0;
+                                    bool wait_to_schedule = false, uint64_t slack_nanos = 0) = 0;
     virtual void cancel(timer_handle_t thandle, bool wait_to_cancel = false) = 0;
 
     /* all Timers are stopped on this thread. It is called when a thread is not part of iomgr */
@@ -153,7 +158,7 @@ public:
     ~timer_epoll() override;
 
     timer_handle_t schedule(uint64_t nanos_after, bool recurring, void* cookie, timer_callback_t&& timer_fn,
-                            bool wait_to_schedule = false) override;
+                            bool wait_to_schedule = false, uint64_t slack_nanos = 0) override;
     void cancel(timer_handle_t thandle, bool wait_to_cancel = false) override;
 
     /* all Timers are stopped on this thread. It is called when a thread is not part of iomgr */
@@ -164,9 +169,12 @@ public:
 private:
     std::shared_ptr< IODevice > setup_timer_fd(bool is_recurring, bool wait_to_setup = false);
     void on_timer_armed(IODevice* iodev);
+    void arm_common_timer(std::chrono::steady_clock::time_point expiry);
 
 private:
     std::shared_ptr< IODevice > m_common_timer_io_dev;                // fd_info for the common timer fd
+    std::unique_ptr< timer_wheel > m_wheel;                           // Non-recurring timers, if wheel enabled
+    std::chrono::steady_clock::time_point m_armed_expiry{std::chrono::steady_clock::time_point::max()};
     std::set< std::shared_ptr< IODevice > > m_recurring_timer_iodevs; // fd infos of recurring timers
 };
 
@@ -176,7 +184,7 @@ public:
     ~timer_spdk() override;
 
     timer_handle_t schedule(uint64_t nanos_after, bool recurring, void* cookie, timer_callback_t&& timer_fn,
-                            bool wait_to_schedule = false) override;
+                            bool wait_to_schedule = false, uint64_t slack_nanos = 0) override;
     void cancel(timer_handle_t thandle, bool wait_to_cancel = false) override;
 
     /* all Timers are stopped on this thread. It is called when a thread is not part of iomgr */
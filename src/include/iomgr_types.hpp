@@ -20,6 +20,7 @@
 
 #include <sisl/utility/enum.hpp>
 #include <sisl/fds/buffer.hpp>
+#include "inline_closure.hpp"
 
 struct spdk_thread;
 struct spdk_bdev_desc;
@@ -69,14 +70,17 @@ typedef std::function< bool(const io_thread_t&) > can_backoff_cb_t;
 typedef std::function< void(iomgr_msg*) > msg_handler_t;
 typedef void (*spdk_msg_signature_t)(void*);
 typedef std::function< void(void) > run_on_closure_t;
-typedef std::function< void(io_thread_addr_t) > run_method_t;
+// Methods run through messages are stored inline in the message (no allocation) upto this size of its captures
+static constexpr size_t run_method_inline_size{96};
+typedef inline_closure< void(io_thread_addr_t), run_method_inline_size > run_method_t;
 typedef uint32_t msg_module_id_t;
 
 struct reschedule_data_t {
     io_device_ptr iodev;
     int event;
 };
-typedef std::variant< sisl::blob, reschedule_data_t, run_method_t > msg_data_t;
+typedef std::vector< iomgr_msg* > msg_batch_t;
+typedef std::variant< sisl::blob, reschedule_data_t, run_method_t, msg_batch_t > msg_data_t;
 
 ENUM(wait_type_t, uint8_t, no_wait, sleep, spin, callback);
 
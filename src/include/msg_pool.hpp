@@ -0,0 +1,157 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace iomgr {
+/**
+ * @brief Per thread cache of memory blocks for objects of type T, which are allocated on one thread and typically
+ * freed on another (messages are allocated by the sender and freed by the receiver). A block freed by any other
+ * thread goes back to the cache of the thread which allocated it, through a lock free stack, so that a thread which
+ * only sends doesn't go to the system allocator for every message, and a thread which only receives doesn't pile up
+ * (or free to the system) blocks it never allocates from.
+ *
+ * Caches are never freed, the cache of an exited thread is adopted by the next thread which needs one, along with the
+ * blocks which are still in flight back to it. Allocations which are not served from the cache are counted, see
+ * system_alloc_count().
+ */
+template < typename T >
+class msg_pool {
+public:
+    static constexpr uint32_t max_cached_blocks{4096}; // Per thread, beyond this freed blocks go back to the system
+
+    static void* alloc() {
+        cache* c{this_cache()};
+        if (c != nullptr) {
+            if (c->local_head == nullptr) { c->reclaim_remote(); }
+            if (auto* hdr = c->local_head) {
+                c->local_head = hdr->next;
+                --c->local_count;
+                return hdr + 1;
+            }
+        }
+
+        auto* hdr{static_cast< block_hdr* >(std::malloc(sizeof(block_hdr) + sizeof(T)))};
+        if (hdr == nullptr) { throw std::bad_alloc(); }
+        s_system_allocs.fetch_add(1, std::memory_order_relaxed);
+        hdr->owner = c;
+        return hdr + 1;
+    }
+
+    static void free(void* mem) {
+        auto* hdr{static_cast< block_hdr* >(mem) - 1};
+        cache* owner{hdr->owner};
+        if (owner == nullptr) {
+            std::free(hdr);
+        } else if (owner == t_cache) {
+            if (owner->local_count >= max_cached_blocks) {
+                std::free(hdr);
+                return;
+            }
+            hdr->next = owner->local_head;
+            owner->local_head = hdr;
+            ++owner->local_count;
+        } else {
+            hdr->next = owner->remote_head.load(std::memory_order_relaxed);
+            while (!owner->remote_head.compare_exchange_weak(hdr->next, hdr, std::memory_order_release,
+                                                             std::memory_order_relaxed)) {}
+        }
+    }
+
+    // Number of blocks allocated from the system so far, across all threads
+    static uint64_t system_alloc_count() { return s_system_allocs.load(std::memory_order_relaxed); }
+
+private:
+    struct cache;
+    struct alignas(std::max_align_t) block_hdr {
+        cache* owner; // nullptr if the block is to be returned to the system
+        block_hdr* next;
+    };
+    static_assert(alignof(T) <= alignof(block_hdr), "Pool blocks are not sufficiently aligned for the type");
+
+    struct cache {
+        // Owner thread only
+        block_hdr* local_head{nullptr};
+        uint32_t local_count{0};
+        bool in_use{true}; // Protected by registry mutex
+
+        // Blocks freed by other threads, taken all at once by the owner
+        std::atomic< block_hdr* > remote_head{nullptr};
+
+        void reclaim_remote() {
+            auto* hdr{remote_head.exchange(nullptr, std::memory_order_acquire)};
+            while (hdr != nullptr) {
+                auto* next{hdr->next};
+                hdr->next = local_head;
+                local_head = hdr;
+                ++local_count;
+                hdr = next;
+            }
+        }
+    };
+
+    struct registry {
+        std::mutex mtx;
+        std::vector< std::unique_ptr< cache > > caches;
+    };
+
+    // Releases the cache of this thread on its exit, for some other thread to adopt
+    struct cache_holder {
+        ~cache_holder() {
+            if (t_cache == nullptr) { return; }
+            std::lock_guard< std::mutex > lg{the_registry().mtx};
+            t_cache->in_use = false;
+            t_cache = nullptr;
+            t_exited = true;
+        }
+    };
+
+    // Never freed, blocks in flight could refer to its caches
+    static registry& the_registry() {
+        static auto* r{new registry()};
+        return *r;
+    }
+
+    static cache* this_cache() {
+        if (t_cache != nullptr) { return t_cache; }
+        if (t_exited) { return nullptr; } // Allocations during thread teardown go to the system
+
+        static thread_local cache_holder t_holder;
+        auto& r{the_registry()};
+        std::lock_guard< std::mutex > lg{r.mtx};
+        for (auto& c : r.caches) {
+            if (!c->in_use) {
+                c->in_use = true;
+                t_cache = c.get();
+                return t_cache;
+            }
+        }
+        t_cache = r.caches.emplace_back(std::make_unique< cache >()).get();
+        return t_cache;
+    }
+
+    static inline std::atomic< uint64_t > s_system_allocs{0};
+    static inline thread_local cache* t_cache{nullptr};
+    static inline thread_local bool t_exited{false};
+};
+} // namespace iomgr
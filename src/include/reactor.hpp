@@ -22,6 +22,7 @@
 #include <chrono>
 #include "iomgr_types.hpp"
 #include "iomgr_timer.hpp"
+#include "task_queue.hpp"
 
 //#include "drive_type.hpp"
 
@@ -60,8 +61,15 @@ public:
 
         REGISTER_GAUGE(iomgr_thread_total_msg_recvd, "Total message received for this thread");
         REGISTER_GAUGE(iomgr_thread_msg_iodev_busy, "Times event read/write EAGAIN for this thread");
+        REGISTER_GAUGE(iomgr_thread_msg_doorbell_avoided, "Messages received without a doorbell wakeup of its own");
+        REGISTER_GAUGE(iomgr_thread_msg_doorbell_count, "Doorbells rung by senders to wake up this thread for msgs");
         REGISTER_GAUGE(iomgr_thread_rescheduled_in, "Times IOs rescheduled into this thread");
         REGISTER_GAUGE(iomgr_thread_outstanding_ops, "IO ops outstanding in this thread");
+        REGISTER_GAUGE(iomgr_thread_msg_qdepth, "Messages queued to this thread yet to be handled");
+        REGISTER_GAUGE(iomgr_thread_drive_ios_inflight, "Drive ios in flight issued by this thread");
+        REGISTER_GAUGE(iomgr_thread_busy_pct, "Moving average of % of time this thread is not waiting for events");
+        REGISTER_GAUGE(iomgr_thread_tasks_run, "Stealable tasks run by this thread (including stolen)");
+        REGISTER_GAUGE(iomgr_thread_tasks_stolen, "Stealable tasks this thread stole from other workers");
 
         REGISTER_GAUGE(iomgr_thread_iface_io_batch_count, "Number of io batches submitted to this thread");
         REGISTER_GAUGE(iomgr_thread_iface_io_actual_count, "Number of actual ios to this thread including batch");
@@ -88,8 +96,15 @@ public:
 
         GAUGE_UPDATE(*this, iomgr_thread_total_msg_recvd, msg_recvd_count);
         GAUGE_UPDATE(*this, iomgr_thread_msg_iodev_busy, msg_iodev_busy_count);
+        GAUGE_UPDATE(*this, iomgr_thread_msg_doorbell_avoided, msg_doorbell_avoided_count);
+        GAUGE_UPDATE(*this, iomgr_thread_msg_doorbell_count, msg_doorbell_count);
         GAUGE_UPDATE(*this, iomgr_thread_rescheduled_in, rescheduled_in);
         GAUGE_UPDATE(*this, iomgr_thread_outstanding_ops, outstanding_ops);
+        GAUGE_UPDATE(*this, iomgr_thread_msg_qdepth, msg_qdepth);
+        GAUGE_UPDATE(*this, iomgr_thread_drive_ios_inflight, drive_ios_inflight);
+        GAUGE_UPDATE(*this, iomgr_thread_busy_pct, busy_pct);
+        GAUGE_UPDATE(*this, iomgr_thread_tasks_run, tasks_run_count);
+        GAUGE_UPDATE(*this, iomgr_thread_tasks_stolen, tasks_stolen_count);
 
         GAUGE_UPDATE(*this, iomgr_thread_iface_io_batch_count, iface_io_batch_count);
         GAUGE_UPDATE(*this, iomgr_thread_iface_io_actual_count, iface_io_actual_count);
@@ -109,8 +124,15 @@ public:
 
     uint64_t msg_recvd_count{0};
     uint64_t msg_iodev_busy_count{0};
+    uint64_t msg_doorbell_avoided_count{0};
+    uint64_t msg_doorbell_count{0};
     uint64_t rescheduled_in{0};
     int64_t outstanding_ops{0};
+    int64_t msg_qdepth{0};
+    int64_t drive_ios_inflight{0};
+    uint64_t busy_pct{0};
+    uint64_t tasks_run_count{0};
+    uint64_t tasks_stolen_count{0};
 
     uint64_t iface_io_batch_count{0};
     uint64_t iface_io_actual_count{0};
@@ -144,6 +166,7 @@ static constexpr loop_type_t TIGHT_LOOP = 1 << 0;     // Completely tight loop c
 static constexpr loop_type_t INTERRUPT_LOOP = 1 << 1; // Interrupt drive loop using epoll or similar mechanism
 static constexpr loop_type_t ADAPTIVE_LOOP = 1 << 2;  // Adaptive approach by backing off before polling upon no-load
 static constexpr loop_type_t USER_CONTROLLED_LOOP = 1 << 3; // User controlled loop where iomgr will poll on-need basis
+static constexpr loop_type_t URING_LOOP = 1 << 4; // Interrupt loop driven by io_uring completions instead of epoll
 
 /****************** Device related *************************/
 inline backing_dev_t null_backing_dev() { return backing_dev_t{std::in_place_type< spdk_bdev_desc* >, nullptr}; }
@@ -172,6 +195,8 @@ public:
     bool ready{false};
     std::atomic< int32_t > thread_op_pending_count{0}; // Number of add/remove of iodev to thread pending
     drive_type dtype{drive_type::unknown};
+    int32_t uring_file_slot{-1}; // Slot of the fd in the registered files of uring drive rings, -1 if not registered
+    bool uring_iopoll{false};    // Ios can be completed by polling (nvme opened with O_DIRECT) on uring IOPOLL ring
 
 #ifdef REFCOUNTED_OPEN_DEV
     sisl::atomic_counter< int > opened_count{0};
@@ -202,6 +227,32 @@ public:
 };
 
 /****************** Reactor related ************************/
+// Load of a reactor, published with relaxed atomics so that selecting a less loaded reactor never needs to touch the
+// reactor itself. Counters published by the reactor thread and the one bumped by the senders are on different cache
+// lines, so that senders don't keep invalidating the owner's line.
+struct reactor_load_t {
+    // A reactor fully busy (never waiting for events) weighs as much as these many queued ios/msgs
+    static constexpr int64_t busy_weight{8};
+
+    alignas(64) std::atomic< int64_t > drive_ios{0};      // Drive ios in flight, published by reactor thread
+    std::atomic< uint64_t > msgs_dequeued{0};             // Published by reactor thread
+    std::atomic< uint32_t > busy_pct{0};                  // EWMA of % of time not waiting, published by reactor thread
+    alignas(64) std::atomic< uint64_t > msgs_enqueued{0}; // Incremented by the senders
+
+    int64_t inflight_ios() const { return drive_ios.load(std::memory_order_relaxed); }
+    uint32_t busy_percent() const { return busy_pct.load(std::memory_order_relaxed); }
+    int64_t msg_qdepth() const {
+        return static_cast< int64_t >(msgs_enqueued.load(std::memory_order_relaxed) -
+                                      msgs_dequeued.load(std::memory_order_relaxed));
+    }
+
+    // Work queued up on the reactor
+    int64_t queued_work() const { return inflight_ios() + msg_qdepth(); }
+
+    // Queued work along with how busy the reactor has been recently
+    int64_t score() const { return queued_work() + ((busy_percent() * busy_weight) / 100); }
+};
+
 struct iomgr_msg;
 struct timer;
 class IOReactor : public std::enable_shared_from_this< IOReactor > {
@@ -255,6 +306,17 @@ public:
     poll_cb_idx_t register_poll_interval_cb(std::function< void(void) >&& cb);
     void unregister_poll_interval_cb(const poll_cb_idx_t idx);
     IOThreadMetrics& thread_metrics() { return *(m_metrics.get()); }
+    const reactor_load_t& load() const { return m_load; }
+    void enqueue_task(stealable_task* task);
+    void run_tasks();
+    // Tasks left behind locally, or stolen some in the last run and the victim could still be backlogged
+    bool has_pending_tasks() const { return (m_task_q && ((m_task_q->size() > 0) || m_keep_stealing)); }
+    void drive_io_submitted(uint32_t count = 1);
+    void drive_io_completed(uint32_t count = 1);
+    // Polled (IOPOLL) drive ios raise no event on completion, listen doesn't wait for events while there are any
+    void polled_io_submitted(uint32_t count) { m_polled_ios += count; }
+    void polled_io_completed(uint32_t count = 1) { m_polled_ios -= count; }
+    bool has_polled_ios() const { return (m_polled_ios != 0); }
     void add_backoff_cb(can_backoff_cb_t&& cb);
     void attach_iomgr_sentinel_cb(const listen_sentinel_cb_t& cb);
     void detach_iomgr_sentinel_cb();
@@ -266,6 +328,12 @@ protected:
     virtual int remove_iodev_internal(const io_device_const_ptr& iodev, const io_thread_t& thr) = 0;
 
     void notify_thread_state(bool is_started);
+
+    void run_task(stealable_task* task);
+    void msg_enqueued() { m_load.msgs_enqueued.fetch_add(1, std::memory_order_relaxed); }
+    void msgs_dequeued(uint32_t count);
+    void account_wait(const std::chrono::steady_clock::time_point& wait_start,
+                      const std::chrono::steady_clock::time_point& wait_end);
     // const io_thread_t& sthread_from_addr(io_thread_addr_t addr);
 
 private:
@@ -299,6 +367,14 @@ protected:
     uint64_t m_cur_backoff_delay_us{0};
     uint64_t m_backoff_delay_min_us{0};
     listen_sentinel_cb_t m_iomgr_sentinel_cb;
+
+    std::unique_ptr< chase_lev_deque< stealable_task > > m_task_q; // Stealable tasks, only for worker reactors
+    bool m_keep_stealing{false}; // Stole tasks in the last run_tasks, don't block in listen before trying again
+    reactor_load_t m_load;
+    int64_t m_drive_ios{0};
+    uint32_t m_polled_ios{0};
+    uint32_t m_busy_pct_ewma{0}; // In 1/256th of a percent
+    std::chrono::steady_clock::time_point m_last_wait_end{std::chrono::steady_clock::now()};
 };
 } // namespace iomgr
 
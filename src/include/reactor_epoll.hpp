@@ -29,7 +29,7 @@ private:
     void reactor_specific_exit_thread(const io_thread_t& thr) override;
     void listen() override;
     void on_msg_fd_notification();
-    void process_messages();
+    uint32_t process_messages();
     void on_user_iodev_notification(IODevice* iodev, int event);
     int add_iodev_internal(const io_device_const_ptr& iodev, const io_thread_t& thr) override;
     int remove_iodev_internal(const io_device_const_ptr& iodev, const io_thread_t& thr) override;
@@ -41,7 +41,7 @@ private:
     void idle_time_wakeup_poller();
 
 private:
-    std::atomic< bool > m_msg_handler_on;           // Is Message handling ongoing now
+    std::atomic< bool > m_parked_in_wait{false};    // Is reactor parked in epoll_wait (needs a doorbell)
     int m_epollfd = -1;                             // Parent epoll context for this thread
     io_device_ptr m_msg_iodev;                      // iodev for the messages
     folly::UMPSCQueue< iomgr_msg*, false > m_msg_q; // Q of message for this thread
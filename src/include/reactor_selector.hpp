@@ -0,0 +1,60 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <sisl/utility/enum.hpp>
+#include "reactor.hpp"
+
+namespace iomgr {
+ENUM(reactor_select_policy_t, uint8_t,
+     round_robin,  // Rotate across all the reactors
+     random,       // Any random reactor
+     power_of_two, // Less loaded of 2 random reactors, load is queued work weighted by how busy the reactor is
+     queue_depth   // Less loaded of 2 random reactors, load is only the drive ios + msgs queued to the reactor
+);
+
+/**
+ * @brief Selects one reactor among a list of reactors (typically the worker reactors), as per the policy set. None
+ * of the policies walk the entire list, it is O(1) per selection. Load of the reactors are read from the relaxed
+ * atomics each reactor publishes (see reactor_load_t), so the selection could be based on slightly stale load,
+ * which is fine for the purpose.
+ */
+class ReactorSelector {
+public:
+    ReactorSelector(reactor_select_policy_t policy = reactor_select_policy_t::power_of_two) : m_policy{policy} {}
+
+    void set_policy(reactor_select_policy_t policy) { m_policy.store(policy, std::memory_order_relaxed); }
+    reactor_select_policy_t policy() const { return m_policy.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Select a reactor from the list. Entries which are not yet started or not io reactors are skipped.
+     *
+     * @return Selected reactor or nullptr if there is no usable reactor in the list
+     */
+    IOReactor* select(const std::vector< std::shared_ptr< IOReactor > >& reactors);
+
+private:
+    IOReactor* pick_random(const std::vector< std::shared_ptr< IOReactor > >& reactors) const;
+    int64_t load_score(const IOReactor* reactor) const;
+
+private:
+    std::atomic< reactor_select_policy_t > m_policy;
+    std::atomic< size_t > m_rr_idx{0};
+};
+} // namespace iomgr
@@ -0,0 +1,79 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+#include <unordered_set>
+#include <liburing.h>
+#include "reactor.hpp"
+#include <folly/concurrency/UnboundedQueue.h>
+
+namespace iomgr {
+// Handler for all completions on the reactor ring which are not owned by reactor itself (drive ios)
+using uring_cqe_handler_t = std::function< void(void* /* user_data */, int32_t /* res */) >;
+
+/**
+ * @brief Reactor which runs its loop entirely on io_uring. Iodevices are watched using one-shot POLL_ADD sqes,
+ * messages are notified through an eventfd which is also polled through the ring. Drive interfaces running on this
+ * thread can share the same ring (see ring() and attach_drive_cqe_handler()), so that their completions are reaped
+ * by the same wait as every other event, instead of an additional eventfd wakeup through epoll.
+ */
+class IOReactorUring : public IOReactor {
+    friend class IOManager;
+
+public:
+    IOReactorUring();
+
+    struct io_uring* ring() { return m_ring_inited ? &m_ring : nullptr; }
+    void attach_drive_cqe_handler(uring_cqe_handler_t&& handler) { m_drive_cqe_handler = std::move(handler); }
+    void detach_drive_cqe_handler() { m_drive_cqe_handler = nullptr; }
+
+private:
+    // Lower bits of the sqe user_data identifies who owns the completion. Drive ios put their iocb pointer as is
+    // (tag = 0), so they don't need to know about the reactor.
+    static constexpr uint64_t cqe_tag_mask{0x7};
+    static constexpr uint64_t cqe_tag_drive_io{0x0};
+    static constexpr uint64_t cqe_tag_iodev_poll{0x1};
+    static constexpr uint64_t cqe_tag_msg_poll{0x2};
+    static constexpr uint64_t cqe_tag_ignore{0x3};
+
+    const char* loop_type() const override { return "Uring"; }
+    bool reactor_specific_init_thread(const io_thread_t& thr) override;
+    void reactor_specific_exit_thread(const io_thread_t& thr) override;
+    void listen() override;
+    int add_iodev_internal(const io_device_const_ptr& iodev, const io_thread_t& thr) override;
+    int remove_iodev_internal(const io_device_const_ptr& iodev, const io_thread_t& thr) override;
+    bool put_msg(iomgr_msg* msg) override;
+
+    bool is_tight_loop_reactor() const override { return false; };
+    bool is_iodev_addable(const io_device_const_ptr& iodev, const io_thread_t& thread) const override;
+
+    struct io_uring_sqe* get_sqe();
+    void arm_iodev_poll(IODevice* iodev);
+    void arm_msg_poll();
+    void handle_cqe(uint64_t user_data, int32_t res);
+    void on_msg_fd_notification();
+    void on_user_iodev_notification(IODevice* iodev, int event);
+    uint32_t process_messages();
+    void idle_time_wakeup_poller();
+
+private:
+    struct io_uring m_ring;
+    bool m_ring_inited{false};
+    int m_msg_evfd{-1};                             // eventfd to wake up the reactor on new messages
+    std::atomic< bool > m_parked_in_wait{false};    // Is reactor parked in the ring wait (needs a doorbell)
+    folly::UMPSCQueue< iomgr_msg*, false > m_msg_q; // Q of message for this thread
+    std::unordered_set< IODevice* > m_armed_iodevs; // iodevs whose poll is armed in this ring
+    uring_cqe_handler_t m_drive_cqe_handler;
+};
+} // namespace iomgr
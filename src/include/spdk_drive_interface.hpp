@@ -83,19 +83,26 @@ struct SpdkIocb;
 
 // static_assert(SPDK_BATCH_IO_NUM > 1);
 
+/**
+ * @brief Watchdog of the outstanding spdk ios. There is one instance per io thread (created only if the watchdog is
+ * turned on) which tracks the ios submitted to spdk by that thread, in an intrusive list ordered by op_submit_time.
+ * Since spdk completes an io on the thread which submitted it, tracking needs no lock and the periodic scan looks
+ * only at the oldest io.
+ */
 class IOWatchDog {
-    typedef SpdkIocb* io_wd_ptr_t;
-
 public:
     IOWatchDog();
     ~IOWatchDog();
 
-    void add_io(const io_wd_ptr_t& iocb);
-    void complete_io(const io_wd_ptr_t& iocb);
+    void add_io(SpdkIocb* iocb);
+    void complete_io(SpdkIocb* iocb);
 
     void io_timer();
 
-    bool is_on();
+    // Watchdog of this thread, nullptr if watchdog is off
+    static IOWatchDog* this_thread() { return t_io_wd; }
+    static void init_this_thread();
+    static void clear_this_thread();
 
     IOWatchDog(const IOWatchDog&) = delete;
     IOWatchDog(IOWatchDog&&) noexcept = delete;
@@ -103,12 +110,11 @@ public:
     IOWatchDog& operator=(IOWatchDog&&) noexcept = delete;
 
 private:
-    bool m_wd_on{false};
+    static thread_local IOWatchDog* t_io_wd;
+
     iomgr::timer_handle_t m_timer_hdl;
-    std::mutex m_mtx;
-    std::map< uint64_t, SpdkIocb* > m_outstanding_ios;
+    io_deadline_tracker< drive_iocb > m_outstanding_ios;
     uint64_t m_wd_pass_cnt{0}; // total watchdog check passed count
-    uint64_t m_unique_id{0};
 };
 
 class SpdkDriveInterface : public DriveInterface {
@@ -133,6 +139,8 @@ public:
                      bool part_of_batch = false) override;
     void async_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
                       bool part_of_batch = false) override;
+    void async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
+                              uint8_t* cookie, bool part_of_batch = false) override;
     void async_read(IODevice* iodev, char* data, uint32_t size, uint64_t offset, uint8_t* cookie,
                     bool part_of_batch = false) override;
     void async_readv(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
@@ -142,7 +150,7 @@ public:
     void write_zero(IODevice* iodev, uint64_t size, uint64_t offset, uint8_t* cookie) override;
     void fsync(IODevice* iodev, uint8_t* cookie) override {
         // LOGMSG_ASSERT(false, "fsync on spdk drive interface is not supported");
-        if (m_comp_cb) m_comp_cb(0, cookie);
+        io_done(submitting_done_fn(), 0, cookie);
     }
 
     io_interface_comp_cb_t& get_completion_cb() { return m_comp_cb; }
@@ -165,7 +173,7 @@ private:
     io_device_ptr create_open_dev_internal(const std::string& devname, drive_type drive_type);
     void open_dev_internal(const io_device_ptr& iodev);
     void init_iface_thread_ctx(const io_thread_t& thr) override;
-    void clear_iface_thread_ctx(const io_thread_t& thr) override {}
+    void clear_iface_thread_ctx(const io_thread_t& thr) override;
 
     void init_iodev_thread_ctx(const io_device_ptr& iodev, const io_thread_t& thr) override;
     void clear_iodev_thread_ctx(const io_device_ptr& iodev, const io_thread_t& thr) override;
@@ -209,15 +217,20 @@ struct SpdkIocb : public drive_iocb {
     spdk_bdev_io_wait_entry io_wait_entry;
     SpdkBatchIocb* batch_info_ptr{nullptr};
     bool owns_by_spdk{false};
-    // used by io watchdog
-    uint64_t unique_id{0};
+    bool flush_issued{false}; // Durable write is written and now the flush of the bdev write cache is outstanding
 
     SpdkIocb(SpdkDriveInterface* iface, IODevice* iodev, DriveOpType op_type, uint64_t size, uint64_t offset,
              void* cookie) :
             drive_iocb{iodev, op_type, size, offset, cookie}, iface{iface} {
+        op_start_time = Clock::now();
         io_wait_entry.bdev = iodev->bdev();
         io_wait_entry.cb_arg = (void*)this;
-        comp_cb = reinterpret_cast< SpdkDriveInterface* >(iodev->io_interface)->m_comp_cb;
+        done_fn = DriveInterface::submitting_done_fn();
+        if (done_fn) {
+            comp_cb = done_fn;
+        } else {
+            comp_cb = reinterpret_cast< SpdkDriveInterface* >(iodev->io_interface)->m_comp_cb;
+        }
     }
 
     std::string to_string() const {
@@ -228,9 +241,9 @@ struct SpdkIocb : public drive_iocb {
         str += fmt::format("spdk={}", owns_by_spdk);
 
         str += fmt::format("addr={}, op_type={}, size={}, offset={}, iovcnt={}, owner_thread={}, batch_sz={}, "
-                           "resubmit_cnt={}, unique_id={}, elapsed_time_us(op_start_time)={}",
+                           "resubmit_cnt={}, elapsed_time_us(op_start_time)={}",
                            (void*)this, enum_name(op_type), size, offset, iovcnt, owner_thread,
-                           batch_info_ptr ? batch_info_ptr->batch_io->size() : 0, resubmit_cnt, unique_id,
+                           batch_info_ptr ? batch_info_ptr->batch_io->size() : 0, resubmit_cnt,
                            get_elapsed_time_us(op_start_time));
 
         if (has_iovs()) {
@@ -0,0 +1,121 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <sisl/fds/obj_allocator.hpp>
+#include "iomgr_types.hpp"
+
+namespace iomgr {
+/**
+ * @brief Bounded Chase-Lev work stealing deque of pointers. Only the owner thread can push() and pop() at the bottom,
+ * any other thread can steal() from the top. Implementation follows "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Le, Pop, Cohen, Nardelli), without the resizing, so push fails once the deque is full.
+ */
+template < typename T >
+class chase_lev_deque {
+public:
+    explicit chase_lev_deque(uint32_t capacity) :
+            m_mask{round_up_pow2(capacity) - 1}, m_buf{new std::atomic< T* >[m_mask + 1]} {}
+    chase_lev_deque(const chase_lev_deque&) = delete;
+    chase_lev_deque& operator=(const chase_lev_deque&) = delete;
+
+    // Owner only
+    bool push(T* item) {
+        const auto b{m_bottom.load(std::memory_order_relaxed)};
+        const auto t{m_top.load(std::memory_order_acquire)};
+        if ((b - t) > static_cast< int64_t >(m_mask)) { return false; }
+        m_buf[b & m_mask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only
+    T* pop() {
+        const auto b{m_bottom.load(std::memory_order_relaxed) - 1};
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t{m_top.load(std::memory_order_relaxed)};
+
+        T* item{nullptr};
+        if (t <= b) {
+            item = m_buf[b & m_mask].load(std::memory_order_relaxed);
+            if (t == b) {
+                // Last item, race with the thieves for it
+                if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread
+    T* steal() {
+        auto t{m_top.load(std::memory_order_acquire)};
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b{m_bottom.load(std::memory_order_acquire)};
+        if (t >= b) { return nullptr; }
+
+        T* item{m_buf[t & m_mask].load(std::memory_order_relaxed)};
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr; // Lost to the owner or another thief
+        }
+        return item;
+    }
+
+    // Approximate when called by anyone other than owner
+    int64_t size() const {
+        const auto b{m_bottom.load(std::memory_order_relaxed)};
+        const auto t{m_top.load(std::memory_order_relaxed)};
+        return (b > t) ? (b - t) : 0;
+    }
+
+private:
+    static uint32_t round_up_pow2(uint32_t n) {
+        uint32_t p{1};
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+private:
+    const uint32_t m_mask;
+    std::unique_ptr< std::atomic< T* >[] > m_buf;
+    alignas(64) std::atomic< int64_t > m_top{0};
+    alignas(64) std::atomic< int64_t > m_bottom{0};
+};
+
+// Fire and forget closure which can be run by any worker reactor
+struct stealable_task {
+    run_method_t method;
+
+    template < class... Args >
+    static stealable_task* create(Args&&... args) {
+        return sisl::ObjectAllocator< stealable_task >::make_object(std::forward< Args >(args)...);
+    }
+    static void free(stealable_task* task) { sisl::ObjectAllocator< stealable_task >::deallocate(task); }
+
+    stealable_task(run_method_t&& m) : method{std::move(m)} {}
+};
+} // namespace iomgr
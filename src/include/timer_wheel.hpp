@@ -0,0 +1,152 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+
+namespace iomgr {
+typedef std::function< void(void*) > timer_callback_t;
+
+/**
+ * @brief Hierarchical timing wheel for recurring and non-recurring timers (Varghese & Lauck, the cascading variant
+ * used by the Linux kernel). There are num_levels wheels of 64 slots each, level L slot covers 64^L ticks. A timer is
+ * placed in the lowest level whose range covers its expiry and gets cascaded down to the lower level when the higher
+ * level slot comes due. Timers beyond the range of the top level are parked at the farthest top level slot and
+ * reinserted when that slot is cascaded.
+ *
+ * schedule() and cancel() are O(1). Timers are kept in a slab of nodes linked by index, so nodes are reused without
+ * allocation and a handle carries a generation, which makes cancel of an already expired timer harmless. Nodes never
+ * move once created, so a popped timer's callback is called in place. Expiry is
+ * never earlier than requested, it is rounded up to the tick.
+ *
+ * A timer can be given a slack (tolerance) window, its expiry is then rounded up to the largest power of two ticks
+ * which fits in the slack. Timers with similar slack thus land on the same tick and get expired (and the timer fd
+ * is armed) once for all of them.
+ *
+ * Expired timers are moved to an expired list, from where the owner pops and calls them one at a time. A timer stays
+ * cancellable till it is popped, so a callback can cancel the timers expired along with it. Popped timer's callback
+ * is kept (not copied) in the node till the owner calls done_expired(), even if the timer is cancelled meanwhile.
+ *
+ * A timer scheduled with an interval is recurring: upon pop the node is re-placed at the next interval, keeping the
+ * same handle. Intervals missed in a single expire() are coalesced into one call.
+ *
+ * The class is not thread safe, the owner is expected to serialize access.
+ */
+class timer_wheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct handle_t {
+        uint32_t idx;
+        uint32_t gen;
+        bool operator==(const handle_t& other) const { return (idx == other.idx) && (gen == other.gen); }
+        bool operator!=(const handle_t& other) const { return !(*this == other); }
+    };
+
+    struct expired_timer_t {
+        const timer_callback_t* cb; // Owned by the wheel, valid till done_expired()
+        void* cookie;
+        uint32_t idx;
+    };
+
+    static constexpr uint32_t num_levels{4};
+    static constexpr uint32_t slot_bits{6};
+    static constexpr uint32_t slots_per_level{1u << slot_bits};
+
+    timer_wheel(uint64_t tick_ns, Clock::time_point base = Clock::now());
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    handle_t schedule(Clock::time_point expiry, void* cookie, timer_callback_t&& fn, uint64_t interval_ns = 0,
+                      uint64_t slack_ns = 0);
+
+    // Returns false if the timer is already expired or cancelled
+    bool cancel(const handle_t& hdl);
+
+    // Move all the timers expired upto the given time to the expired list, in the order of expiry tick. Returns the
+    // number of timers expired
+    size_t expire(Clock::time_point now);
+
+    // Pop the earliest timer from the expired list into out, false if the list is empty
+    bool pop_expired(expired_timer_t& out);
+
+    // Owner is done calling the popped timer
+    void done_expired(const expired_timer_t& e);
+
+    // Time at which the timer is going to expire (after slack rounding), nullopt if it is not pending
+    std::optional< Clock::time_point > expiry_time(const handle_t& hdl) const;
+
+    // Drop all the pending timers without calling them
+    void clear();
+
+    // Earliest time at which expire() could have something to do (a timer due or a cascade), nullopt if empty. It
+    // is in the past if there are expired timers yet to be popped
+    std::optional< Clock::time_point > next_expiry() const;
+
+    size_t size() const { return m_count; }
+    bool empty() const { return (m_count == 0); }
+    uint64_t tick_ns() const { return m_tick_ns; }
+
+private:
+    static constexpr uint32_t invalid_idx{UINT32_MAX};
+    static constexpr uint32_t num_slots{num_levels * slots_per_level};
+    static constexpr uint32_t expired_slot{num_slots}; // Slot of the nodes in the expired list
+
+    struct node {
+        timer_callback_t cb;
+        void* cookie{nullptr};
+        uint64_t due_tick{0};       // Requested expiry
+        uint64_t expiry_tick{0};    // Requested expiry rounded up within the slack
+        uint64_t interval_ticks{0}; // 0 for non-recurring
+        uint64_t align_ticks{1};    // Power of 2, upto the slack
+        uint32_t gen{0};
+        uint32_t in_call{0};        // Pops of this timer whose call is not done yet
+        bool free_on_return{false}; // Free the node once the calls in progress are done
+        uint32_t slot{invalid_idx}; // invalid_idx if node is free or not pending
+        uint32_t prev{invalid_idx};
+        uint32_t next{invalid_idx};
+    };
+
+    uint32_t alloc_node();
+    void free_node(uint32_t idx);
+    void release_node(uint32_t idx);
+    void place(uint32_t idx);
+    void link(uint32_t idx, uint32_t slot);
+    void link_expired(uint32_t idx);
+    void unlink(uint32_t idx);
+    void cascade(uint32_t level);
+    size_t expire_slot(uint32_t slot);
+    uint64_t tick_ceil(Clock::time_point t) const;
+    uint64_t tick_floor(Clock::time_point t) const;
+    static uint64_t align_up(uint64_t tick, uint64_t align) { return (tick + align - 1) & ~(align - 1); }
+
+private:
+    const uint64_t m_tick_ns;
+    const Clock::time_point m_base;
+    uint64_t m_cur_tick{0}; // Next tick to be processed, all ticks before this are processed
+    size_t m_count{0};
+    uint32_t m_free_head{invalid_idx};
+    std::deque< node > m_nodes;
+    std::array< uint32_t, num_slots > m_slot_head;
+    std::array< uint64_t, num_levels > m_occupied{}; // Bitmap of non-empty slots per level
+    uint32_t m_expired_head{invalid_idx};
+    uint32_t m_expired_tail{invalid_idx};
+};
+} // namespace iomgr
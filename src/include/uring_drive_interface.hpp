@@ -17,9 +17,10 @@
 #include <unistd.h>
 #include <string>
 #include <stack>
-#include <queue>
+#include <deque>
 #include <atomic>
 #include <mutex>
+#include <vector>
 
 #include <fcntl.h>
 #include <liburing.h>
@@ -48,10 +49,15 @@ public:
         REGISTER_COUNTER(retry_on_partial_read, "number of times ios are retried on partial read");
         REGISTER_COUNTER(overflow_errors, "number of CQ overflow occurrences");
         REGISTER_COUNTER(num_of_drops, "number of dropped ios due to CQ overflow");
+        REGISTER_COUNTER(io_timeouts, "number of ios outstanding beyond the io timeout");
+        REGISTER_COUNTER(io_cancel_failures, "number of timed out ios which could not be cancelled");
+        REGISTER_HISTOGRAM(stuck_io_duration_ms, "Time taken by the ios which exceeded the io timeout to complete");
 
         REGISTER_COUNTER(outstanding_write_cnt, "outstanding write cnt", sisl::_publish_as::publish_as_gauge);
         REGISTER_COUNTER(outstanding_read_cnt, "outstanding read cnt", sisl::_publish_as::publish_as_gauge);
         REGISTER_COUNTER(outstanding_fsync_cnt, "outstanding fsync cnt", sisl::_publish_as::publish_as_gauge);
+        REGISTER_COUNTER(outstanding_unmap_cnt, "outstanding unmap cnt", sisl::_publish_as::publish_as_gauge);
+        REGISTER_COUNTER(outstanding_write_zero_cnt, "outstanding write zero cnt", sisl::_publish_as::publish_as_gauge);
 
         register_me_to_farm();
     }
@@ -61,20 +67,55 @@ public:
 // Per thread structure which has all details for uring
 class UringDriveInterface;
 struct uring_drive_channel {
-    struct io_uring m_ring;
-    std::queue< drive_iocb* > m_iocb_waitq;
+    struct io_uring m_own_ring;
+    // Ring used for ios. It is either our own ring or the ring of uring reactor, if the thread runs on one
+    struct io_uring* m_ring{&m_own_ring};
+    bool m_shared_ring{false};
+    // Set if the ring is polled by SQ poll thread and if this ring owns the poll thread other rings attach to
+    bool m_sqpoll{false};
+    bool m_owns_sqpoll_wq{false};
+    // Set if the io buffer arena is registered with the ring, ios on arena buffers are then issued as fixed buffer ios
+    bool m_fixed_bufs{false};
+    // Fd registered at each slot of the fixed files table of the ring, -1 if the slot is empty. Empty if the table
+    // could not be registered
+    std::vector< int > m_registered_fds;
+    // Single buffer ios are issued as READ/WRITE op, without an iovec
+    bool m_plain_rw{false};
+    // Ring created with IORING_SETUP_IOPOLL for the ios of polled devices, reaped by polling every reactor loop.
+    // It has its own registered buffers and files, but shares the wait queue and queue depth with the other ring.
+    struct io_uring m_iopoll_ring;
+    bool m_iopoll{false};
+    bool m_iopoll_fixed_bufs{false};
+    std::vector< int > m_iopoll_registered_fds;
+    uint32_t m_iopoll_prepared_ios{0};
+    uint32_t m_iopoll_in_flight_ios{0};
+    std::deque< drive_iocb* > m_iocb_waitq;
     io_device_ptr m_ring_ev_iodev;
     // prepared_ios are IOs sent to uring but not submitted yet
     uint32_t m_prepared_ios{0};
     // in_flight_ios are IOs submitted to uring, but not completed yet
     uint32_t m_in_flight_ios{0};
+    // Max ios in flight (across the rings), so that neither the queue depth nor the CQ size is exceeded
+    uint32_t m_max_in_flight_ios{0};
+    // Completions dropped by the kernel so far, as last seen on the CQ overflow counter of the rings. With
+    // IORING_FEAT_NODROP kernel keeps the completions which don't fit in CQ and drops only on memory shortage
+    uint32_t m_cq_overflow{0};
+    uint32_t m_iopoll_cq_overflow{0};
+    // Ios of this thread which the kernel has taken, to catch the ones which are stuck. An io resubmitted from the wait
+    // queue keeps its first deadline. Tracked only if io_deadline is enabled
+    bool m_track_deadlines{false};
+    io_deadline_tracker< drive_iocb > m_deadline_tracker;
+    // Ios prepared on the SQ of each ring, in SQ order, till io_uring_submit takes them (nullptr for a cancel request)
+    std::vector< drive_iocb* > m_prepared_iocbs;
+    std::vector< drive_iocb* > m_iopoll_prepared_iocbs;
+    timer_handle_t m_deadline_timer{null_timer_handle};
 
     uring_drive_channel(UringDriveInterface* iface);
     ~uring_drive_channel();
     drive_iocb* pop_waitq() {
         if (m_iocb_waitq.size() == 0) { return nullptr; }
         drive_iocb* iocb = m_iocb_waitq.front();
-        m_iocb_waitq.pop();
+        m_iocb_waitq.pop_front();
         return iocb;
     }
 
@@ -85,11 +126,28 @@ struct uring_drive_channel {
     bool can_submit() const;
     void submit_if_needed(drive_iocb* iocb, struct io_uring_sqe*, bool part_of_batch);
     void drain_waitq();
+    bool unlink_waitq(drive_iocb* iocb);
+    void track_submitted(std::vector< drive_iocb* >& prepared_iocbs, uint32_t count);
+    bool cancel_io(drive_iocb* iocb);
+    void prep_sqe_from_iocb(drive_iocb* iocb, struct io_uring_sqe* sqe);
+    bool is_fixed_buf(const drive_iocb* iocb, const void* buf, size_t len) const;
+    bool register_fixed_bufs(struct io_uring* ring);
+    void register_fixed_files(struct io_uring* ring, std::vector< int >& registered_fds);
+    int fixed_file_idx(const drive_iocb* iocb);
+    void unregister_fixed_file(int32_t slot);
+    void init_iopoll_ring();
+    // Durable writes stay on the interrupt driven ring, since a write with cache flush isn't polled by the driver
+    bool is_iopoll_io(const drive_iocb* iocb) const {
+        return m_iopoll && iocb->iodev->uring_iopoll && !iocb->durable && iocb->is_rw();
+    }
+    struct io_uring* ring_of(const drive_iocb* iocb) { return is_iopoll_io(iocb) ? &m_iopoll_ring : m_ring; }
+    void on_io_reaped(bool iopoll_io);
 };
 
 class UringDriveInterface : public KernelDriveInterface {
 public:
-    static constexpr uint32_t per_thread_qdepth = 256;
+    // Max cqes reaped in one go
+    static constexpr uint32_t max_reap_batch = 64;
 
     UringDriveInterface(const io_interface_comp_cb_t& cb = nullptr);
     virtual ~UringDriveInterface() = default;
@@ -102,20 +160,27 @@ public:
                      bool part_of_batch = false) override;
     void async_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
                       bool part_of_batch = false) override;
+    void async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
+                              uint8_t* cookie, bool part_of_batch = false) override;
     void async_read(IODevice* iodev, char* data, uint32_t size, uint64_t offset, uint8_t* cookie,
                     bool part_of_batch = false) override;
     void async_readv(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset, uint8_t* cookie,
                      bool part_of_batch = false) override;
     void async_unmap(IODevice* iodev, uint32_t size, uint64_t offset, uint8_t* cookie,
                      bool part_of_batch = false) override;
+    void write_zero(IODevice* iodev, uint64_t size, uint64_t offset, uint8_t* cookie) override;
     void fsync(IODevice* iodev, uint8_t* cookie) override;
+    void async_io(drive_iocb* iocb, bool part_of_batch = false) override;
 
     void on_event_notification(IODevice* iodev, void* cookie, int event);
     void handle_completions();
+    void poll_completions();
+    void on_io_completion(drive_iocb* iocb, int32_t res);
     virtual void submit_batch() override;
-    static void increment_outstanding_counter(const drive_iocb* iocb, UringDriveInterface* iface);
-    static void decrement_outstanding_counter(const drive_iocb* iocb, UringDriveInterface* iface);
+    static void increment_outstanding_counter(drive_iocb* iocb, UringDriveInterface* iface);
+    static void decrement_outstanding_counter(drive_iocb* iocb, UringDriveInterface* iface);
     UringDriveInterfaceMetrics& get_metrics() { return m_metrics; }
+    bool plain_rw_supported() const { return m_plain_rw_supported; }
 
 private:
     void init_iface_thread_ctx(const io_thread_t& thr) override;
@@ -123,10 +188,24 @@ private:
     void init_iodev_thread_ctx(const io_device_ptr& iodev, const io_thread_t& thr) override {}
     void clear_iodev_thread_ctx(const io_device_ptr& iodev, const io_thread_t& thr) override {}
 
-    void complete_io(drive_iocb* iocb);
+    void complete_io(drive_iocb* iocb, bool in_flight = true);
+    void submit_iocb(drive_iocb* iocb, bool part_of_batch);
+    void check_io_deadlines();
+    void reap_completions(struct io_uring* ring, uint32_t& last_overflow);
+    int32_t alloc_file_slot();
+    void free_file_slot(int32_t slot);
 
 private:
     static thread_local uring_drive_channel* t_uring_ch;
     UringDriveInterfaceMetrics m_metrics;
+
+    // Ops which kernel supports, as probed at start
+    const bool m_plain_rw_supported;
+    const bool m_fallocate_supported;
+
+    // Slots of the registered files table in use by the opened devices. Each ring registers the device at the same
+    // slot, lazily upon its first io from that ring
+    std::mutex m_file_slots_mtx;
+    std::vector< bool > m_file_slot_used;
 };
 } // namespace iomgr
@@ -135,10 +135,19 @@ void AioDriveInterface::init_iface_thread_ctx([[maybe_unused]] const io_thread_t
     t_aio_ctx->iocb_info_prealloc(MAX_OUTSTANDING_IO);
     t_aio_ctx->poll_cb_idx =
         iomanager.this_reactor()->register_poll_interval_cb(bind_this(AioDriveInterface::handle_completions, 0));
+
+    if (IM_DYNAMIC_CONFIG(io_deadline.enabled)) {
+        const auto interval_ns{IM_DYNAMIC_CONFIG(io_deadline.check_interval_ms) * 1000ul * 1000ul};
+        t_aio_ctx->track_deadlines = true;
+        t_aio_ctx->deadline_timer = iomanager.schedule_thread_timer(
+            interval_ns, interval_ns /* slack */, true /* recurring */, nullptr,
+            [this]([[maybe_unused]] void* cookie) { check_io_deadlines(); });
+    }
 }
 
 void AioDriveInterface::clear_iface_thread_ctx([[maybe_unused]] const io_thread_t& thr) {
     iomanager.this_reactor()->unregister_poll_interval_cb(t_aio_ctx->poll_cb_idx);
+    if (t_aio_ctx->track_deadlines) { iomanager.cancel_timer(t_aio_ctx->deadline_timer); }
 
     int err = io_destroy(t_aio_ctx->ioctx);
     if (err) { LOGERROR("io_destroy failed with ret status={} errno={}", err, errno); }
@@ -189,7 +198,13 @@ void AioDriveInterface::handle_completions() {
 #endif
         if (ret < 0) {
             COUNTER_INCREMENT(m_metrics, completion_errors, 1);
-            LOGDFATAL("Error in completion of aio, result: {} info: {}", ret, info->to_string());
+            if (info->deadline_hook.timed_out) {
+                // Most likely cancelled by us
+                LOGERROR("Timed out aio completed with result: {} info: {}", ret, info->to_string());
+                e.res2 = -ret;
+            } else {
+                LOGDFATAL("Error in completion of aio, result: {} info: {}", ret, info->to_string());
+            }
         } else if ((e.res != info->size) || e.res2) {
             COUNTER_INCREMENT(m_metrics, completion_errors, 1);
             LOGERROR("io is not completed properly. size read/written {} info {} error {}", e.res, info->to_string(),
@@ -198,14 +213,51 @@ void AioDriveInterface::handle_completions() {
             if (resubmit_iocb_on_err(iocb)) { continue; }
         }
 
-        auto user_cookie = (uint8_t*)iocb->data;
-        t_aio_ctx->dec_submitted_aio();
-        t_aio_ctx->free_iocb(iocb);
-        retry_io();
-        if (m_comp_cb) { m_comp_cb(e.res2, user_cookie); }
+        complete_iocb(iocb, e.res2);
+    }
+}
+
+void AioDriveInterface::complete_iocb(struct iocb* iocb, int64_t res) {
+    auto user_cookie = (uint8_t*)iocb->data;
+    const auto done_fn{static_cast< iocb_info_t* >(iocb)->done_fn};
+    const auto stuck_ms{t_aio_ctx->deadline_tracker.remove((iocb_info_t*)iocb)};
+    if (stuck_ms) { HISTOGRAM_OBSERVE(m_metrics, stuck_io_duration_ms, stuck_ms); }
+
+    t_aio_ctx->dec_submitted_aio();
+    t_aio_ctx->free_iocb(iocb);
+    retry_io();
+    io_done(done_fn, res, user_cookie);
+}
+
+void AioDriveInterface::check_io_deadlines() {
+    const auto timeout_ms{IM_DYNAMIC_CONFIG(io_deadline.timeout_ms)};
+    const auto cutoff{Clock::now() - std::chrono::milliseconds(timeout_ms)};
+
+    iocb_info_t* info;
+    while ((info = t_aio_ctx->deadline_tracker.pop_expired(cutoff)) != nullptr) {
+        const auto outstanding_ms{get_elapsed_time_ms(info->deadline_hook.submit_time)};
+        COUNTER_INCREMENT(m_metrics, io_timeouts, 1);
+        LOGERROR("IO outstanding for {} ms, beyond the timeout={} ms, cancelling it, info: {}", outstanding_ms,
+                 timeout_ms, info->to_string());
+
+        if (m_io_timeout_cb) { m_io_timeout_cb((uint8_t*)info->data, outstanding_ms); }
+        if (!cancel_io(info)) { COUNTER_INCREMENT(m_metrics, io_cancel_failures, 1); }
     }
 }
 
+bool AioDriveInterface::cancel_io(iocb_info_t* info) {
+    struct io_event ev;
+    const auto ret{io_cancel(t_aio_ctx->ioctx, static_cast< struct iocb* >(info), &ev)};
+    if (ret == 0) {
+        // Older kernels hand over the cancelled event right here instead of posting it to the completion ring
+        complete_iocb(static_cast< struct iocb* >(info), ECANCELED);
+        return true;
+    }
+
+    // Kernel block/file aio mostly can't cancel (EINVAL), in which case we keep waiting for the io to complete
+    return (ret == -EINPROGRESS);
+}
+
 bool AioDriveInterface::resubmit_iocb_on_err(struct iocb* iocb) {
     auto info = (iocb_info_t*)iocb;
     if (info->resubmit_cnt > IM_DYNAMIC_CONFIG(max_resubmit_cnt)) { return false; }
@@ -239,6 +291,7 @@ void AioDriveInterface::async_write(IODevice* iodev, const char* data, uint32_t
             handle_io_failure(iocb);
             return;
         }
+        t_aio_ctx->track_deadline((iocb_info_t*)iocb);
     }
 }
 
@@ -263,25 +316,37 @@ void AioDriveInterface::async_read(IODevice* iodev, char* data, uint32_t size, u
             handle_io_failure(iocb);
             return;
         }
+        t_aio_ctx->track_deadline((iocb_info_t*)iocb);
     }
 }
 
 void AioDriveInterface::async_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
                                      uint8_t* cookie, bool part_of_batch) {
+    submit_writev(iodev, iov, iovcnt, size, offset, cookie, part_of_batch, 0 /* rw_flags */);
+}
+
+void AioDriveInterface::async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size,
+                                             uint64_t offset, uint8_t* cookie, bool part_of_batch) {
+    // Per io O_DSYNC, so that kernel completes the write only after it is stable (FUA or write + flush)
+    submit_writev(iodev, iov, iovcnt, size, offset, cookie, part_of_batch, RWF_DSYNC);
+}
+
+void AioDriveInterface::submit_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
+                                      uint8_t* cookie, bool part_of_batch, int rw_flags) {
     if (!t_aio_ctx->can_submit_aio()
 #ifdef _PRERELEASE
         || flip::Flip::instance().test_flip("io_write_iocb_empty_flip")
 #endif
     ) {
-        auto iocb = t_aio_ctx->prep_iocb_v(false, iodev->fd(), false, iov, iovcnt, size, offset, cookie);
+        auto iocb = t_aio_ctx->prep_iocb_v(false, iodev->fd(), false, iov, iovcnt, size, offset, cookie, rw_flags);
         push_retry_list(iocb, true /* no_slot */);
         return;
     }
     if (part_of_batch && t_aio_ctx->can_be_batched(iovcnt)) {
         t_aio_ctx->prep_iocb_v(true /* batch_io */, iodev->fd(), false /* is_read */, iov, iovcnt, size, offset,
-                               cookie);
+                               cookie, rw_flags);
     } else {
-        auto iocb = t_aio_ctx->prep_iocb_v(false, iodev->fd(), false, iov, iovcnt, size, offset, cookie);
+        auto iocb = t_aio_ctx->prep_iocb_v(false, iodev->fd(), false, iov, iovcnt, size, offset, cookie, rw_flags);
         auto& metrics = iomanager.this_thread_metrics();
         ++metrics.iface_io_batch_count;
         ++metrics.iface_io_actual_count;
@@ -292,6 +357,7 @@ void AioDriveInterface::async_writev(IODevice* iodev, const iovec* iov, int iovc
             handle_io_failure(iocb);
             return;
         }
+        t_aio_ctx->track_deadline((iocb_info_t*)iocb);
     }
 }
 
@@ -321,6 +387,7 @@ void AioDriveInterface::async_readv(IODevice* iodev, const iovec* iov, int iovcn
             handle_io_failure(iocb);
             return;
         }
+        t_aio_ctx->track_deadline((iocb_info_t*)iocb);
     }
 }
 
@@ -339,6 +406,9 @@ void AioDriveInterface::submit_batch() {
     if (n_issued < 0) { n_issued = 0; }
     metrics.iface_io_actual_count += n_issued;
     t_aio_ctx->inc_submitted_aio(n_issued);
+    for (auto i = 0; i < n_issued; ++i) {
+        t_aio_ctx->track_deadline(ibatch.iocb_info[i]);
+    }
 
     // For those which we are not able to issue, convert that to sync io
     auto n_iocbs = ibatch.n_iocbs;
@@ -355,7 +425,11 @@ void AioDriveInterface::retry_io() {
         COUNTER_DECREMENT(m_metrics, retry_list_size, 1);
         auto ret = io_submit(t_aio_ctx->ioctx, 1, &iocb);
         t_aio_ctx->inc_submitted_aio(ret);
-        if (ret != 1 && handle_io_failure(iocb)) { break; }
+        if (ret == 1) {
+            t_aio_ctx->track_deadline((iocb_info_t*)iocb);
+        } else if (handle_io_failure(iocb)) {
+            break;
+        }
     }
 }
 
@@ -384,8 +458,11 @@ bool AioDriveInterface::handle_io_failure(struct iocb* iocb) {
         LOGERROR("io submit fail: io info: {}, errno: {}", info->to_string(), errno);
         COUNTER_INCREMENT_IF_ELSE(m_metrics, info->is_read, read_io_submission_errors, write_io_submission_errors, 1);
         ret = false;
+        const auto err{errno};
+        const auto done_fn{info->done_fn};
+        auto user_cookie = (uint8_t*)iocb->data;
         t_aio_ctx->free_iocb(iocb);
-        if (m_comp_cb) m_comp_cb(errno, (uint8_t*)iocb->data);
+        io_done(done_fn, err, user_cookie);
     }
     return ret;
 }
@@ -407,6 +484,7 @@ void AioDriveInterface::init_poll_interval_table() {
 /////////////////////////// aio_thread_context /////////////////////////////////////////////////
 void aio_thread_context::dec_submitted_aio() {
     --submitted_aio;
+    iomanager.this_reactor()->drive_io_completed();
     iomanager.this_reactor()->set_poll_interval((submitted_aio >= AioDriveInterface::s_poll_interval_table.size())
                                                     ? 0
                                                     : AioDriveInterface::s_poll_interval_table[submitted_aio]);
@@ -415,6 +493,7 @@ void aio_thread_context::dec_submitted_aio() {
 void aio_thread_context::inc_submitted_aio(int count) {
     if (count < 0) { return; }
     submitted_aio += count;
+    iomanager.this_reactor()->drive_io_submitted(count);
 
     iomanager.this_reactor()->set_poll_interval(submitted_aio >= AioDriveInterface::s_poll_interval_table.size()
                                                     ? 0
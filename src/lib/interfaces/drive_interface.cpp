@@ -43,6 +43,7 @@ std::mutex DriveInterface::s_dev_type_lookup_mtx;
 
 std::unordered_map< std::string, drive_attributes > DriveInterface::s_dev_attrs;
 std::mutex DriveInterface::s_dev_attrs_lookup_mtx;
+thread_local drive_iocb::io_done_fn_t DriveInterface::t_submitting_done_fn{nullptr};
 
 static std::string get_mounted_device(const std::string& filename) {
     struct stat s;
@@ -275,6 +276,48 @@ io_device_ptr DriveInterface::open_dev(const std::string& dev_name, int oflags)
 
 size_t DriveInterface::get_size(IODevice* iodev) { return iodev->drive_interface()->get_dev_size(iodev); }
 
+void DriveInterface::async_io(drive_iocb* iocb, bool part_of_batch) {
+    auto* cookie{static_cast< uint8_t* >(iocb->user_cookie)};
+
+    // Io could complete inline and its done_fn could submit the next one, so restore rather than clear on the way out
+    const auto prev_done_fn{t_submitting_done_fn};
+    t_submitting_done_fn = iocb->done_fn;
+    switch (iocb->op_type) {
+    case DriveOpType::WRITE:
+        if (iocb->durable && !iocb->has_iovs()) {
+            const iovec iov{iocb->get_data(), iocb->size};
+            async_writev_durable(iocb->iodev, &iov, 1, iocb->size, iocb->offset, cookie, part_of_batch);
+        } else if (iocb->durable) {
+            async_writev_durable(iocb->iodev, iocb->get_iovs(), iocb->iovcnt, iocb->size, iocb->offset, cookie,
+                                 part_of_batch);
+        } else if (iocb->has_iovs()) {
+            async_writev(iocb->iodev, iocb->get_iovs(), iocb->iovcnt, iocb->size, iocb->offset, cookie, part_of_batch);
+        } else {
+            async_write(iocb->iodev, iocb->get_data(), iocb->size, iocb->offset, cookie, part_of_batch);
+        }
+        break;
+    case DriveOpType::READ:
+        if (iocb->has_iovs()) {
+            async_readv(iocb->iodev, iocb->get_iovs(), iocb->iovcnt, iocb->size, iocb->offset, cookie, part_of_batch);
+        } else {
+            async_read(iocb->iodev, iocb->get_data(), iocb->size, iocb->offset, cookie, part_of_batch);
+        }
+        break;
+    case DriveOpType::UNMAP:
+        async_unmap(iocb->iodev, iocb->size, iocb->offset, cookie, part_of_batch);
+        break;
+    case DriveOpType::WRITE_ZERO:
+        write_zero(iocb->iodev, iocb->size, iocb->offset, cookie);
+        break;
+    case DriveOpType::FSYNC:
+        fsync(iocb->iodev, cookie);
+        break;
+    default:
+        LOGDFATAL("Invalid operation type {}", iocb->op_type);
+    }
+    t_submitting_done_fn = prev_done_fn;
+}
+
 /////////////////////////// KernelDriveInterface Section /////////////////////////////////////
 size_t KernelDriveInterface::get_dev_size(IODevice* iodev) {
     if (std::filesystem::is_regular_file(std::filesystem::status(iodev->devname))) {
@@ -459,7 +502,7 @@ void KernelDriveInterface::write_zero_ioctl(const IODevice* iodev, uint64_t size
         offset += this_size;
         size -= this_size;
     }
-    if (m_comp_cb) { m_comp_cb(((ret != 0) ? errno : 0), cookie); }
+    io_done(submitting_done_fn(), ((ret != 0) ? errno : 0), cookie);
 #endif
 }
 
@@ -496,7 +539,7 @@ void KernelDriveInterface::write_zero_writev(IODevice* iodev, uint64_t size, uin
 
     assert(total_sz_written == size);
 
-    if (m_comp_cb) { m_comp_cb(errno, cookie); }
+    io_done(submitting_done_fn(), errno, cookie);
 }
 
 } // namespace iomgr
@@ -250,72 +250,63 @@ static void create_dev_internal(const std::shared_ptr< creat_ctx >& ctx) {
     }
 }
 
-IOWatchDog::IOWatchDog() {
-    m_wd_on = IM_DYNAMIC_CONFIG(spdk->io_watchdog_timer_on);
-
-    if (m_wd_on) {
-        m_timer_hdl = iomanager.schedule_global_timer(
-            IM_DYNAMIC_CONFIG(spdk->io_watchdog_timer_sec) * 1000ul * 1000ul * 1000ul, true, nullptr,
-            iomgr::thread_regex::all_worker, [this](void* cookie) { io_timer(); });
-    }
+thread_local IOWatchDog* IOWatchDog::t_io_wd{nullptr};
 
-    LOGINFOMOD(io_wd, "io watchdog turned {}.", m_wd_on ? "ON" : "OFF");
+void IOWatchDog::init_this_thread() {
+    if ((t_io_wd == nullptr) && IM_DYNAMIC_CONFIG(spdk->io_watchdog_timer_on)) { t_io_wd = new IOWatchDog(); }
 }
 
-IOWatchDog::~IOWatchDog() { m_outstanding_ios.clear(); }
+void IOWatchDog::clear_this_thread() {
+    if (t_io_wd != nullptr) {
+        delete t_io_wd;
+        t_io_wd = nullptr;
+    }
+}
 
-void IOWatchDog::add_io(const io_wd_ptr_t& iocb) {
-    {
-        std::unique_lock< std::mutex > lk(m_mtx);
-        iocb->unique_id = ++m_unique_id;
+IOWatchDog::IOWatchDog() {
+    // Precision of the scan doesn't matter, so let the timers of all threads coalesce
+    const auto interval_ns{IM_DYNAMIC_CONFIG(spdk->io_watchdog_timer_sec) * 1000ul * 1000ul * 1000ul};
+    m_timer_hdl = iomanager.schedule_thread_timer(interval_ns, interval_ns /* slack */, true /* recurring */, nullptr,
+                                                  [this](void* cookie) { io_timer(); });
+    LOGINFOMOD(io_wd, "io watchdog turned ON for this thread.");
+}
 
-        const auto result = m_outstanding_ios.insert_or_assign(iocb->unique_id, iocb);
-        LOGTRACEMOD(io_wd, "add_io: {}, {}", iocb->unique_id, iocb->to_string());
-        RELEASE_ASSERT_EQ(result.second, true, "expecting to insert instead of update");
-    }
+IOWatchDog::~IOWatchDog() {
+    iomanager.cancel_timer(m_timer_hdl);
+    LOGDEBUGMOD(io_wd, "io watchdog stopped with {} outstanding ios on this thread.", m_outstanding_ios.size());
 }
 
-void IOWatchDog::complete_io(const io_wd_ptr_t& iocb) {
-    {
-        std::unique_lock< std::mutex > lk(m_mtx);
-        const auto result = m_outstanding_ios.erase(iocb->unique_id);
-        LOGTRACEMOD(io_wd, "complete_io: {}, {}", iocb->unique_id, iocb->to_string());
-        RELEASE_ASSERT_EQ(result, 1, "expecting to erase 1 element");
-    }
+void IOWatchDog::add_io(SpdkIocb* iocb) {
+    // IO resubmitted on error or on memory pressure is already being tracked since its first submission
+    if (iocb->deadline_hook.linked) { return; }
+    m_outstanding_ios.add(iocb, iocb->op_submit_time);
+    LOGTRACEMOD(io_wd, "add_io: {}", iocb->to_string());
 }
 
-bool IOWatchDog::is_on() { return m_wd_on; }
+void IOWatchDog::complete_io(SpdkIocb* iocb) {
+    LOGTRACEMOD(io_wd, "complete_io: {}", iocb->to_string());
+    m_outstanding_ios.remove(iocb);
+}
 
 void IOWatchDog::io_timer() {
-    {
-        std::unique_lock< std::mutex > lk(m_mtx);
-        std::vector< io_wd_ptr_t > timeout_reqs;
-        // the 1st io iteratred in map will be the oldeset one, because we add io
-        // to map when vol_child_req is being created, e.g. op_start_time is from oldeset to latest;
-        for (const auto& io : m_outstanding_ios) {
-            const auto this_io_dur_us = get_elapsed_time_us(io.second->op_start_time);
-            if (this_io_dur_us >= IM_DYNAMIC_CONFIG(spdk->io_timeout_limit_sec) * 1000ul * 1000ul) {
-                // coolect all timeout requests
-                timeout_reqs.push_back(io.second);
-            } else {
-                // no need to search for newer requests stored in the map;
-                break;
-            }
-        }
-
-        if (timeout_reqs.size()) {
-            LOGCRITICAL_AND_FLUSH(
-                "Total num timeout requests: {}, the oldest io req that timeout duration is: {},  iocb: {}",
-                timeout_reqs.size(), get_elapsed_time_us(timeout_reqs[0]->op_start_time), timeout_reqs[0]->to_string());
+    // Ios are in the order of submission, so only the expired ones at the head of the list are looked at
+    const auto cutoff{Clock::now() - std::chrono::seconds(IM_DYNAMIC_CONFIG(spdk->io_timeout_limit_sec))};
+    auto* oldest{static_cast< SpdkIocb* >(m_outstanding_ios.pop_expired(cutoff))};
+    if (oldest == nullptr) {
+        LOGDEBUGMOD(io_wd, "io_timer passed {}, no timed out IO found. Total outstanding_io_cnt: {}",
+                    ++m_wd_pass_cnt, m_outstanding_ios.size());
+        return;
+    }
 
-            RELEASE_ASSERT(false, "IO watchdog timeout! timeout_limit: {}, watchdog_timer: {}",
-                           IM_DYNAMIC_CONFIG(spdk->io_timeout_limit_sec),
-                           IM_DYNAMIC_CONFIG(spdk->io_watchdog_timer_sec));
-        } else {
-            LOGDEBUGMOD(io_wd, "io_timer passed {}, no timee out IO found. Total outstanding_io_cnt: {}",
-                        ++m_wd_pass_cnt, m_outstanding_ios.size());
-        }
+    uint64_t num_timeouts{1};
+    while (m_outstanding_ios.pop_expired(cutoff) != nullptr) {
+        ++num_timeouts;
     }
+    LOGCRITICAL_AND_FLUSH("Total num timeout requests: {}, the oldest io req that timeout duration is: {},  iocb: {}",
+                          num_timeouts, get_elapsed_time_us(oldest->op_submit_time), oldest->to_string());
+
+    RELEASE_ASSERT(false, "IO watchdog timeout! timeout_limit: {}, watchdog_timer: {}",
+                   IM_DYNAMIC_CONFIG(spdk->io_timeout_limit_sec), IM_DYNAMIC_CONFIG(spdk->io_watchdog_timer_sec));
 }
 
 io_device_ptr SpdkDriveInterface::open_dev(const std::string& devname, drive_type drive_type,
@@ -456,8 +447,11 @@ void SpdkDriveInterface::init_iface_thread_ctx(const io_thread_t& thr) {
         thr->reactor->add_backoff_cb(
             [](const io_thread_t& t) -> bool { return (t->reactor->m_metrics->outstanding_ops == 0); });
     }
+    IOWatchDog::init_this_thread();
 }
 
+void SpdkDriveInterface::clear_iface_thread_ctx(const io_thread_t& thr) { IOWatchDog::clear_this_thread(); }
+
 void SpdkDriveInterface::init_iodev_thread_ctx(const io_device_ptr& iodev, const io_thread_t& thr) {
     if (!thr->reactor->is_tight_loop_reactor()) {
         // If we are asked to initialize the thread context for non-spdk thread reactor, then create one spdk
@@ -503,8 +497,6 @@ static bool resubmit_io_on_err(void* b) {
 static void complete_io(SpdkIocb* iocb) {
     SpdkDriveInterface::decrement_outstanding_counter(iocb);
 
-    if (iomanager.get_io_wd()->is_on()) { iomanager.get_io_wd()->complete_io(iocb); }
-
     [[maybe_unused]] const auto prev_outstanding_count =
         SpdkDriveInterface::decrement_outstanding_asyncios(iocb, 1 + iocb->resubmit_cnt);
 
@@ -542,6 +534,16 @@ static void process_completions(spdk_bdev_io* bdev_io, bool success, void* ctx)
 
     if (success) {
         iocb->result = 0;
+        if (iocb->durable && !iocb->flush_issued &&
+            spdk_bdev_io_type_supported(iocb->iodev->bdev(), SPDK_BDEV_IO_TYPE_FLUSH)) {
+            // Generic bdev layer has no FUA write, so chain the flush of the written range right here instead of
+            // a round trip to the caller. Bdevs which don't support flush have no volatile cache to flush.
+            LOGDEBUGMOD(iomgr, "(bdev_io={}) iocb written, flushing: {}", (void*)bdev_io, iocb->to_string());
+            iocb->flush_issued = true;
+            SpdkDriveInterface::decrement_outstanding_asyncios(iocb);
+            submit_io(iocb);
+            return;
+        }
         LOGDEBUGMOD(iomgr, "(bdev_io={}) iocb complete: mode=actual, {}", (void*)bdev_io, iocb->to_string());
     } else {
         LOGERRORMOD(iomgr, "(bdev_io={}) iocb failed with status [{}]: mode=actual, {}", (void*)bdev_io,
@@ -550,6 +552,7 @@ static void process_completions(spdk_bdev_io* bdev_io, bool success, void* ctx)
         if (resubmit_io_on_err(iocb)) { return; }
         iocb->result = -1;
     }
+    if (auto* wd{IOWatchDog::this_thread()}) { wd->complete_io(iocb); }
 
     const bool started_by_this_thread{(iocb->owner_thread == nullptr)};
 
@@ -577,6 +580,7 @@ static void submit_io(void* b) {
     SpdkDriveInterface::increment_outstanding_asyncios(iocb);
     iocb->op_submit_time = Clock::now();
     ++(iomanager.this_thread_metrics().drive_io_count);
+    if (auto* wd{IOWatchDog::this_thread()}) { wd->add_io(iocb); }
 
     LOGDEBUGMOD(iomgr, "iocb submit: mode=actual, {}", iocb->to_string());
     if (iocb->op_type == DriveOpType::READ) {
@@ -588,7 +592,10 @@ static void submit_io(void* b) {
                                 iocb->size, process_completions, (void*)iocb);
         }
     } else if (iocb->op_type == DriveOpType::WRITE) {
-        if (iocb->has_iovs()) {
+        if (iocb->flush_issued) {
+            rc = spdk_bdev_flush(iocb->iodev->bdev_desc(), get_io_channel(iocb->iodev), iocb->offset, iocb->size,
+                                 process_completions, (void*)iocb);
+        } else if (iocb->has_iovs()) {
             rc = spdk_bdev_writev(iocb->iodev->bdev_desc(), get_io_channel(iocb->iodev), iocb->get_iovs(), iocb->iovcnt,
                                   iocb->offset, iocb->size, process_completions, (void*)iocb);
         } else {
@@ -642,6 +649,7 @@ void SpdkDriveInterface::increment_outstanding_counter(const SpdkIocb* iocb) {
     }
 
     ++(iomanager.this_thread_metrics().outstanding_ops);
+    if (iomanager.this_reactor()) { iomanager.this_reactor()->drive_io_submitted(); }
 }
 
 void SpdkDriveInterface::decrement_outstanding_counter(const SpdkIocb* iocb) {
@@ -663,6 +671,7 @@ void SpdkDriveInterface::decrement_outstanding_counter(const SpdkIocb* iocb) {
         LOGDFATAL("Invalid operation type {}", iocb->op_type);
     }
     --(iomanager.this_thread_metrics().outstanding_ops);
+    if (iomanager.this_reactor()) { iomanager.this_reactor()->drive_io_completed(); }
 }
 
 inline size_t SpdkDriveInterface::increment_outstanding_asyncios(const SpdkIocb* iocb, size_t count) {
@@ -693,9 +702,6 @@ inline bool SpdkDriveInterface::try_submit_io(SpdkIocb* iocb, bool part_of_batch
 
     // update counter in async path;
     if (ret) { increment_outstanding_counter(iocb); }
-
-    if (iomanager.get_io_wd()->is_on()) { IOManager::instance().get_io_wd()->add_io(iocb); }
-
     return ret;
 }
 
@@ -726,6 +732,16 @@ void SpdkDriveInterface::async_writev(IODevice* iodev, const iovec* iov, int iov
     if (!try_submit_io(iocb, part_of_batch)) { do_sync_io(iocb, m_comp_cb); }
 }
 
+void SpdkDriveInterface::async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size,
+                                              uint64_t offset, uint8_t* cookie, bool part_of_batch) {
+    SpdkIocb* iocb{
+        sisl::ObjectAllocator< SpdkIocb >::make_object(this, iodev, DriveOpType::WRITE, size, offset, cookie)};
+    iocb->set_iovs(iov, iovcnt);
+    iocb->durable = true;
+    iocb->io_wait_entry.cb_fn = submit_io;
+    if (!try_submit_io(iocb, part_of_batch)) { do_sync_io(iocb, m_comp_cb); }
+}
+
 void SpdkDriveInterface::async_readv(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
                                      uint8_t* cookie, bool part_of_batch) {
     SpdkIocb* iocb{
@@ -797,8 +813,6 @@ ssize_t SpdkDriveInterface::do_sync_io(SpdkIocb* iocb, const io_interface_comp_c
     // update counter in sync path
     increment_outstanding_counter(iocb);
 
-    if (iomanager.get_io_wd()->is_on()) { IOManager::instance().get_io_wd()->add_io(iocb); }
-
     const auto& reactor = iomanager.this_reactor();
     if (reactor && reactor->is_io_reactor() && !reactor->is_tight_loop_reactor()) {
         submit_sync_io_in_this_thread(iocb);
@@ -807,7 +821,14 @@ ssize_t SpdkDriveInterface::do_sync_io(SpdkIocb* iocb, const io_interface_comp_c
     }
 
     const auto ret = (iocb->result == 0) ? iocb->size : 0;
-    if (comp_cb) comp_cb(iocb->result, static_cast< uint8_t* >(iocb->user_cookie));
+    if (comp_cb) {
+        // Async io which fell back to sync, goes to its own completion if it came through async_io()
+        if (iocb->done_fn) {
+            iocb->done_fn(iocb->result, static_cast< uint8_t* >(iocb->user_cookie));
+        } else {
+            comp_cb(iocb->result, static_cast< uint8_t* >(iocb->user_cookie));
+        }
+    }
     complete_io(iocb);
 
     return ret;
@@ -958,7 +979,7 @@ void SpdkDriveInterface::handle_msg(iomgr_msg* msg) {
     case spdk_msg_type::ASYNC_IO_DONE: {
         auto* iocb = reinterpret_cast< SpdkIocb* >(msg->data_buf().bytes);
         LOGDEBUGMOD(iomgr, "iocb complete: mode=user_reactor, {}", iocb->to_string());
-        if (m_comp_cb) m_comp_cb(iocb->result, static_cast< uint8_t* >(iocb->user_cookie));
+        io_done(iocb->done_fn, iocb->result, static_cast< uint8_t* >(iocb->user_cookie));
         complete_io(iocb);
         break;
     }
@@ -966,7 +987,7 @@ void SpdkDriveInterface::handle_msg(iomgr_msg* msg) {
     case spdk_msg_type::ASYNC_BATCH_IO_DONE: {
         const auto* batch_info = reinterpret_cast< SpdkBatchIocb* >(msg->data_buf().bytes);
         for (auto& iocb : *(batch_info->batch_io)) {
-            if (m_comp_cb) { m_comp_cb(iocb->result, static_cast< uint8_t* >(iocb->user_cookie)); }
+            io_done(iocb->done_fn, iocb->result, static_cast< uint8_t* >(iocb->user_cookie));
             complete_io(iocb);
         }
 
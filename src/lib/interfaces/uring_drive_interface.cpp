@@ -14,6 +14,7 @@
  **************************************************************************/
 #include "uring_drive_interface.hpp"
 #include "iomgr.hpp"
+#include "reactor_uring.hpp"
 
 #if defined __clang__ or defined __GNUC__
 #pragma GCC diagnostic push
@@ -28,28 +29,133 @@
 
 #ifdef __linux__
 #include <sys/epoll.h>
+#include <linux/falloc.h>
+#include <sys/syscall.h>
 #include <linux/version.h>
 #endif
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <sisl/fds/utils.hpp>
 #include <sisl/logging/logging.h>
 
 namespace iomgr {
 thread_local uring_drive_channel* UringDriveInterface::t_uring_ch{nullptr};
 
+// Fd of the ring whose SQ poll thread is shared by the rings of other threads, -1 if there is none yet
+static std::atomic< int > s_sqpoll_wq_fd{-1};
+
+static int init_ring(struct io_uring* ring, uint32_t setup_flags, bool sqpoll, int attach_wq_fd,
+                     struct io_uring_params& params) {
+    std::memset(&params, 0, sizeof(params));
+    params.flags = setup_flags;
+    const auto cq_entries{IM_DYNAMIC_CONFIG(uring->cq_entries)};
+    if (cq_entries != 0) {
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = cq_entries;
+    }
+    if (sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = IM_DYNAMIC_CONFIG(uring->sqpoll_idle_ms);
+        if (attach_wq_fd != -1) {
+            params.flags |= IORING_SETUP_ATTACH_WQ;
+            params.wq_fd = attach_wq_fd;
+        }
+    }
+    return io_uring_queue_init_params(IM_DYNAMIC_CONFIG(uring->queue_depth), ring, &params);
+}
+
+// Sq poll thread of older kernels (below 5.11) picks up only the ios on registered files, which not every io is issued
+// on (files beyond the registered slots aren't)
+static bool sqpoll_nonfixed_supported(const struct io_uring_params& params) {
+#ifdef IORING_FEAT_SQPOLL_NONFIXED
+    return (params.features & IORING_FEAT_SQPOLL_NONFIXED);
+#else
+    return false;
+#endif
+}
+
+// Flush the completions kernel kept aside upon CQ overflow (IORING_FEAT_NODROP) to CQ, now that we made some room
+static void flush_overflowed_cqes(struct io_uring* ring) {
+#ifdef IORING_SQ_CQ_OVERFLOW
+    if (IO_URING_READ_ONCE(*ring->sq.kflags) & IORING_SQ_CQ_OVERFLOW) {
+        syscall(__NR_io_uring_enter, ring->ring_fd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+#endif
+}
+
 uring_drive_channel::uring_drive_channel(UringDriveInterface* iface) {
-    // TODO: For now setup as interrupt mode instead of pollmode
 #if LINUX_VERSION_CODE < KERNEL_VERSION(5, 4, 0)
     RELEASE_ASSERT(0, "Not expected to run io_uring below kernel 5.4!");
 #endif
+    m_plain_rw = iface->plain_rw_supported() && IM_DYNAMIC_CONFIG(uring->plain_rw_enabled);
+
+    // If this thread runs an uring reactor, share its ring, so that io completions are reaped along with all
+    // other reactor events, without an additional eventfd notification.
+    auto ureactor = dynamic_cast< IOReactorUring* >(iomanager.this_reactor());
+    if ((ureactor != nullptr) && (ureactor->ring() != nullptr)) {
+        m_ring = ureactor->ring();
+        m_shared_ring = true;
+        // Reactor's own events also complete on this CQ, keep the room for them
+        m_max_in_flight_ios = std::min(IM_DYNAMIC_CONFIG(uring->queue_depth), *m_ring->cq.kring_entries / 2);
+        ureactor->attach_drive_cqe_handler([iface](void* user_data, int32_t res) {
+            iface->on_io_completion(static_cast< drive_iocb* >(user_data), res);
+        });
+        m_fixed_bufs = register_fixed_bufs(m_ring);
+        register_fixed_files(m_ring, m_registered_fds);
+        init_iopoll_ring();
+        if (m_iopoll) { iomanager.this_reactor()->attach_iomgr_sentinel_cb([iface]() { iface->poll_completions(); }); }
+        return;
+    }
 
-    int ret = io_uring_queue_init(UringDriveInterface::per_thread_qdepth, &m_ring, 0);
+    bool sqpoll{IM_DYNAMIC_CONFIG(uring->sqpoll_enabled)};
+    const bool shared_wq{sqpoll && IM_DYNAMIC_CONFIG(uring->sqpoll_shared)};
+    const int attach_wq_fd{shared_wq ? s_sqpoll_wq_fd.load(std::memory_order_acquire) : -1};
+
+    struct io_uring_params params;
+    int ret = init_ring(m_ring, 0, sqpoll, attach_wq_fd, params);
+    if (ret && (attach_wq_fd != -1)) {
+        // Ring we attach to could have been closed in the meantime, get our own poll thread instead
+        LOGWARNMOD(iomgr, "Unable to attach to the sq poll thread of ring fd={}, error={}", attach_wq_fd, ret);
+        ret = init_ring(m_ring, 0, sqpoll, -1, params);
+    }
+    if (ret && sqpoll) {
+        LOGWARNMOD(iomgr, "Unable to create uring queue in sqpoll mode, error={}, using interrupt mode", ret);
+        sqpoll = false;
+        ret = init_ring(m_ring, 0, false, -1, params);
+    }
+    if (!ret && sqpoll && !sqpoll_nonfixed_supported(params)) {
+        // Decided on the running kernel rather than the one we are built against
+        LOGWARNMOD(iomgr, "Uring sqpoll of this kernel polls only the registered files, using interrupt mode");
+        io_uring_queue_exit(m_ring);
+        sqpoll = false;
+        ret = init_ring(m_ring, 0, false, -1, params);
+    }
     if (ret) { folly::throwSystemError(fmt::format("Unable to create uring queue created ret={}", ret)); }
+    m_max_in_flight_ios = std::min(params.sq_entries, params.cq_entries);
+    if (!(params.features & IORING_FEAT_NODROP)) {
+        LOGWARNMOD(iomgr, "Kernel could drop the completions of uring fd={} upon CQ overflow", m_ring->ring_fd);
+    }
+
+    m_sqpoll = sqpoll;
+    if (m_sqpoll && shared_wq && !(params.flags & IORING_SETUP_ATTACH_WQ)) {
+        int expected{-1};
+        m_owns_sqpoll_wq = s_sqpoll_wq_fd.compare_exchange_strong(expected, m_ring->ring_fd);
+    }
+    if (m_sqpoll) {
+        LOGINFOMOD(iomgr, "Uring drive ring fd={} created in sqpoll mode, attached to poll thread of ring fd={}",
+                   m_ring->ring_fd, (params.flags & IORING_SETUP_ATTACH_WQ) ? attach_wq_fd : m_ring->ring_fd);
+    }
+
+    m_fixed_bufs = register_fixed_bufs(m_ring);
+    register_fixed_files(m_ring, m_registered_fds);
+    init_iopoll_ring();
 
     int ev_fd = eventfd(0, EFD_NONBLOCK);
     if (ev_fd == -1) { folly::throwSystemError("Unable to create eventfd to listen for uring queue events"); }
 
-    ret = io_uring_register_eventfd(&m_ring, ev_fd);
+    ret = io_uring_register_eventfd(m_ring, ev_fd);
     if (ret == -1) { folly::throwSystemError("Unable to register event fd to uring queue"); }
 
     // Create io device and add it local thread
@@ -57,11 +163,51 @@ uring_drive_channel::uring_drive_channel(UringDriveInterface* iface) {
     m_ring_ev_iodev = iomanager.generic_interface()->make_io_device(
         backing_dev_t(ev_fd), EPOLLIN, 0, nullptr, true,
         std::bind(&UringDriveInterface::on_event_notification, iface, _1, _2, _3));
-    iomanager.this_reactor()->attach_iomgr_sentinel_cb([iface]() { iface->handle_completions(); });
+    iomanager.this_reactor()->attach_iomgr_sentinel_cb([iface]() {
+        iface->handle_completions();
+        iface->poll_completions();
+    });
+}
+
+void uring_drive_channel::init_iopoll_ring() {
+    if (!IM_DYNAMIC_CONFIG(uring->iopoll_enabled)) { return; }
+
+    // Polled completions don't raise any event, reactor keeps polling (doesn't wait in listen) while there are polled
+    // ios in flight, whatever its poll interval is now or later
+    auto* r{iomanager.this_reactor()};
+    struct io_uring_params params;
+    const auto ret{init_ring(&m_iopoll_ring, IORING_SETUP_IOPOLL, false, -1, params)};
+    if (ret) {
+        LOGWARNMOD(iomgr, "Unable to create uring iopoll ring, error={}, polled devices use the interrupt ring", ret);
+        return;
+    }
+    m_iopoll = true;
+    m_max_in_flight_ios = std::min({m_max_in_flight_ios, params.sq_entries, params.cq_entries});
+    m_iopoll_fixed_bufs = register_fixed_bufs(&m_iopoll_ring);
+    register_fixed_files(&m_iopoll_ring, m_iopoll_registered_fds);
+    LOGINFOMOD(iomgr, "Uring iopoll ring fd={} created for reactor {}", m_iopoll_ring.ring_fd, r->reactor_idx());
 }
 
 uring_drive_channel::~uring_drive_channel() {
-    io_uring_queue_exit(&m_ring);
+    if (m_shared_ring) {
+        // Reactor ring outlives us, so don't leave the arena pinned on it
+        if (m_fixed_bufs) { io_uring_unregister_buffers(m_ring); }
+        if (!m_registered_fds.empty()) { io_uring_unregister_files(m_ring); }
+        static_cast< IOReactorUring* >(iomanager.this_reactor())->detach_drive_cqe_handler();
+        if (m_iopoll) {
+            iomanager.this_reactor()->detach_iomgr_sentinel_cb();
+            io_uring_queue_exit(&m_iopoll_ring);
+        }
+        return;
+    }
+
+    if (m_owns_sqpoll_wq) {
+        // Rings already attached keep the poll thread running, just don't let new ones attach to a closed fd
+        int expected{m_ring->ring_fd};
+        s_sqpoll_wq_fd.compare_exchange_strong(expected, -1);
+    }
+    io_uring_queue_exit(m_ring);
+    if (m_iopoll) { io_uring_queue_exit(&m_iopoll_ring); }
     if (m_ring_ev_iodev != nullptr) {
         iomanager.this_reactor()->detach_iomgr_sentinel_cb();
         iomanager.generic_interface()->remove_io_device(m_ring_ev_iodev);
@@ -71,14 +217,14 @@ uring_drive_channel::~uring_drive_channel() {
 
 struct io_uring_sqe* uring_drive_channel::get_sqe_or_enqueue(drive_iocb* iocb) {
     if (!can_submit()) {
-        m_iocb_waitq.push(iocb);
+        m_iocb_waitq.push_back(iocb);
         return nullptr;
     }
-    struct io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+    struct io_uring_sqe* sqe = io_uring_get_sqe(ring_of(iocb));
     if (!sqe) {
         // No available slots. Before enqueing we submit ios which were added as part of batch processing.
         submit_ios();
-        m_iocb_waitq.push(iocb);
+        m_iocb_waitq.push_back(iocb);
         return nullptr;
     }
 
@@ -86,8 +232,35 @@ struct io_uring_sqe* uring_drive_channel::get_sqe_or_enqueue(drive_iocb* iocb) {
 }
 
 void uring_drive_channel::submit_ios() {
+    // Submission could be refused with -EBUSY while kernel holds overflowed completions (or -EAGAIN on memory
+    // shortage). Prepared ios are then left in SQ and submitted again after the next reap.
+    if (m_iopoll_prepared_ios != 0) {
+        const auto ret = io_uring_submit(&m_iopoll_ring);
+        DEBUG_ASSERT((ret > 0) || (ret == -EBUSY) || (ret == -EAGAIN),
+                     "Facing an error in io_uring_submit of iopoll ring");
+        if (ret > 0) {
+            m_iopoll_in_flight_ios += ret;
+            m_iopoll_prepared_ios -= ret;
+            if (iomanager.this_reactor()) { iomanager.this_reactor()->polled_io_submitted(ret); }
+            track_submitted(m_iopoll_prepared_iocbs, ret);
+        }
+    }
+
     if (m_prepared_ios != 0) {
-        const auto ret = io_uring_submit(&m_ring);
+        const auto ret = io_uring_submit(m_ring);
+        if ((ret == -EBUSY) || (ret == -EAGAIN)) {
+            LOGDEBUGMOD(iomgr, "Uring fd={} refused submission, error={}, retrying after reap", m_ring->ring_fd, ret);
+            return;
+        }
+        if (m_shared_ring) {
+            // Reactor could have flushed some of our prepared sqes along with its own sqes, so the return value
+            // doesn't exactly match what we prepared. Either way the SQ is flushed to kernel now.
+            DEBUG_ASSERT_GE(ret, 0, "Facing an error in io_uring_submit");
+            m_in_flight_ios += m_prepared_ios;
+            track_submitted(m_prepared_iocbs, m_prepared_ios);
+            m_prepared_ios = 0;
+            return;
+        }
         if (static_cast< int >(m_prepared_ios) < ret) {
             DEBUG_ASSERT(false, "prepared ios must be always equal or greater than just-submitted ios");
         }
@@ -95,50 +268,193 @@ void uring_drive_channel::submit_ios() {
         m_in_flight_ios += ret;
 
         m_prepared_ios -= ret;
+        track_submitted(m_prepared_iocbs, ret);
     }
 }
 
+void uring_drive_channel::track_submitted(std::vector< drive_iocb* >& prepared_iocbs, uint32_t count) {
+    if (!m_track_deadlines) { return; }
+
+    // Kernel consumes the SQ in order, so the ios it has taken are the oldest prepared ones. Unmap/zero of a range
+    // takes time in proportion to its size (formatting the whole device is one op), so they are not held to the io
+    // deadline
+    const auto taken_end{prepared_iocbs.begin() + std::min< size_t >(count, prepared_iocbs.size())};
+    for (auto it{prepared_iocbs.begin()}; it != taken_end; ++it) {
+        auto* iocb{*it};
+        if ((iocb == nullptr) || iocb->deadline_hook.linked) { continue; }
+        if (iocb->is_rw() || (iocb->op_type == DriveOpType::FSYNC)) { m_deadline_tracker.add(iocb); }
+    }
+    prepared_iocbs.erase(prepared_iocbs.begin(), taken_end);
+}
+
 void uring_drive_channel::submit_if_needed(drive_iocb* iocb, struct io_uring_sqe* sqe, bool part_of_batch) {
     io_uring_sqe_set_data(sqe, (void*)iocb);
-    ++m_prepared_ios;
+    if (is_iopoll_io(iocb)) {
+        ++m_iopoll_prepared_ios;
+        if (m_track_deadlines) { m_iopoll_prepared_iocbs.push_back(iocb); }
+    } else {
+        ++m_prepared_ios;
+        if (m_track_deadlines) { m_prepared_iocbs.push_back(iocb); }
+    }
     if (!part_of_batch) { submit_ios(); }
 }
 
-static void prep_sqe_from_iocb(drive_iocb* iocb, struct io_uring_sqe* sqe) {
+void uring_drive_channel::prep_sqe_from_iocb(drive_iocb* iocb, struct io_uring_sqe* sqe) {
+    // With the registered file, fd field of sqe carries its index in the fixed files table
+    const int file_idx{fixed_file_idx(iocb)};
+    const int fd{(file_idx != -1) ? file_idx : iocb->iodev->fd()};
     switch (iocb->op_type) {
     case DriveOpType::WRITE:
-        if (iocb->has_iovs()) {
-            io_uring_prep_writev(sqe, iocb->iodev->fd(), iocb->get_iovs(), iocb->iovcnt, iocb->offset);
-        } else {
-            io_uring_prep_write(sqe, iocb->iodev->fd(), (const void*)iocb->get_data(), iocb->size, iocb->offset);
+    case DriveOpType::READ: {
+        const bool is_write{iocb->op_type == DriveOpType::WRITE};
+        void* buf{nullptr};
+        uint32_t len{0};
+        if (!iocb->has_iovs()) {
+            buf = iocb->get_data();
+            len = iocb->size;
+        } else if (iocb->iovcnt == 1) {
+            buf = iocb->get_iovs()[0].iov_base;
+            len = static_cast< uint32_t >(iocb->get_iovs()[0].iov_len);
         }
-        break;
 
-    case DriveOpType::READ:
-        if (iocb->has_iovs()) {
-            io_uring_prep_readv(sqe, iocb->iodev->fd(), iocb->get_iovs(), iocb->iovcnt, iocb->offset);
+        if ((buf != nullptr) && is_fixed_buf(iocb, buf, len)) {
+            // Single buffer within the registered arena, kernel need not pin the pages for this io
+            if (is_write) {
+                io_uring_prep_write_fixed(sqe, fd, buf, len, iocb->offset, 0 /* buf_index */);
+            } else {
+                io_uring_prep_read_fixed(sqe, fd, buf, len, iocb->offset, 0 /* buf_index */);
+            }
+        } else if (iocb->has_iovs() && ((buf == nullptr) || !m_plain_rw)) {
+            if (is_write) {
+                io_uring_prep_writev(sqe, fd, iocb->get_iovs(), iocb->iovcnt, iocb->offset);
+            } else {
+                io_uring_prep_readv(sqe, fd, iocb->get_iovs(), iocb->iovcnt, iocb->offset);
+            }
         } else {
-            io_uring_prep_read(sqe, iocb->iodev->fd(), (void*)iocb->get_data(), iocb->size, iocb->offset);
+            if (is_write) {
+                io_uring_prep_write(sqe, fd, buf, len, iocb->offset);
+            } else {
+                io_uring_prep_read(sqe, fd, buf, len, iocb->offset);
+            }
         }
+        // Durable write is a per io O_DSYNC, kernel issues it as FUA write (or write + flush) and completes after
+        if (iocb->durable) { sqe->rw_flags = RWF_DSYNC; }
         break;
+    }
 
     case DriveOpType::FSYNC:
-        io_uring_prep_fsync(sqe, iocb->iodev->fd(), IORING_FSYNC_DATASYNC);
+        io_uring_prep_fsync(sqe, fd, IORING_FSYNC_DATASYNC);
+        break;
+
+    // Fallocate runs in kernel io worker. On a block device punch hole is a write zeroes with deallocate (unmap) and
+    // zero range is a zeroout which falls back to writing zeros if the device can't offload it; on a file these are
+    // the usual deallocate and zeroing of the range
+    case DriveOpType::UNMAP:
+        io_uring_prep_fallocate(sqe, fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, iocb->offset, iocb->size);
+        break;
+
+    case DriveOpType::WRITE_ZERO:
+        io_uring_prep_fallocate(sqe, fd, FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE, iocb->offset, iocb->size);
         break;
 
     default:
         break;
     }
+    if (file_idx != -1) { sqe->flags |= IOSQE_FIXED_FILE; }
+}
+
+bool uring_drive_channel::is_fixed_buf(const drive_iocb* iocb, const void* buf, size_t len) const {
+    return (is_iopoll_io(iocb) ? m_iopoll_fixed_bufs : m_fixed_bufs) && iomanager.fixed_buf_arena()->owns(buf, len);
+}
+
+bool uring_drive_channel::register_fixed_bufs(struct io_uring* ring) {
+    auto* arena{iomanager.fixed_buf_arena()};
+    if (arena == nullptr) { return false; }
+
+    const auto ret{io_uring_register_buffers(ring, &arena->iov(), 1)};
+    if (ret < 0) {
+        // Mostly RLIMIT_MEMLOCK is not enough to pin the arena. Ios still go through, just without fixed buffers, so
+        // there is no point in serving io buffers from the arena any longer
+        LOGWARNMOD(iomgr, "Unable to register io buffer arena of size={} with uring fd={}, error={}", arena->size(),
+                   ring->ring_fd, ret);
+        iomanager.disable_fixed_buf_arena();
+        return false;
+    }
+    return true;
+}
+
+void uring_drive_channel::register_fixed_files(struct io_uring* ring, std::vector< int >& registered_fds) {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 5, 0)
+    const auto nslots{IM_DYNAMIC_CONFIG(uring->registered_files)};
+    if (nslots == 0) { return; }
+
+    // Register an empty (sparse) table, devices are filled in by update upon their first io on this ring
+    std::vector< int > fds(nslots, -1);
+    const auto ret{io_uring_register_files(ring, fds.data(), nslots)};
+    if (ret < 0) {
+        LOGWARNMOD(iomgr, "Unable to register files table of size={} with uring fd={}, error={}", nslots,
+                   ring->ring_fd, ret);
+        return;
+    }
+    registered_fds = std::move(fds);
+#endif
+}
+
+int uring_drive_channel::fixed_file_idx(const drive_iocb* iocb) {
+    const auto* iodev{iocb->iodev};
+    const auto slot{iodev->uring_file_slot};
+    const bool iopoll{is_iopoll_io(iocb)};
+    auto& registered_fds{iopoll ? m_iopoll_registered_fds : m_registered_fds};
+    if ((slot == -1) || (static_cast< size_t >(slot) >= registered_fds.size())) { return -1; }
+
+    if (registered_fds[slot] != iodev->fd()) {
+        auto* ring{iopoll ? &m_iopoll_ring : m_ring};
+        int fd{iodev->fd()};
+        const auto ret{io_uring_register_files_update(ring, slot, &fd, 1)};
+        if (ret != 1) {
+            LOGWARNMOD(iomgr, "Unable to register fd={} of device={} at slot={} with uring fd={}, error={}", fd,
+                       iodev->devname, slot, ring->ring_fd, ret);
+            return -1;
+        }
+        registered_fds[slot] = fd;
+    }
+    return slot;
+}
+
+void uring_drive_channel::unregister_fixed_file(int32_t slot) {
+    const auto unregister = [slot](struct io_uring* ring, std::vector< int >& registered_fds) {
+        if ((static_cast< size_t >(slot) >= registered_fds.size()) || (registered_fds[slot] == -1)) { return; }
+
+        int fd{-1};
+        const auto ret{io_uring_register_files_update(ring, slot, &fd, 1)};
+        if (ret != 1) {
+            LOGERRORMOD(iomgr, "Unable to unregister fd={} at slot={} from uring fd={}, error={}", registered_fds[slot],
+                        slot, ring->ring_fd, ret);
+        }
+        registered_fds[slot] = -1;
+    };
+
+    unregister(m_ring, m_registered_fds);
+    if (m_iopoll) { unregister(&m_iopoll_ring, m_iopoll_registered_fds); }
 }
 
 bool uring_drive_channel::can_submit() const {
-    return (m_in_flight_ios + m_prepared_ios) <= UringDriveInterface::per_thread_qdepth;
+    return (m_in_flight_ios + m_prepared_ios + m_iopoll_in_flight_ios + m_iopoll_prepared_ios) < m_max_in_flight_ios;
+}
+
+void uring_drive_channel::on_io_reaped(bool iopoll_io) {
+    if (iopoll_io) {
+        --m_iopoll_in_flight_ios;
+        if (iomanager.this_reactor()) { iomanager.this_reactor()->polled_io_completed(); }
+    } else {
+        --m_in_flight_ios;
+    }
 }
 
 void uring_drive_channel::drain_waitq() {
     while (m_iocb_waitq.size() != 0) {
         if (!can_submit()) { break; };
-        struct io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+        struct io_uring_sqe* sqe = io_uring_get_sqe(ring_of(m_iocb_waitq.front()));
         if (sqe == nullptr) {
             DEBUG_ASSERT(false, "Don't expect sqe to be full or unavailable");
             return;
@@ -150,15 +466,75 @@ void uring_drive_channel::drain_waitq() {
     }
 }
 
+bool uring_drive_channel::unlink_waitq(drive_iocb* iocb) {
+    const auto it{std::find(m_iocb_waitq.begin(), m_iocb_waitq.end(), iocb)};
+    if (it == m_iocb_waitq.end()) { return false; }
+    m_iocb_waitq.erase(it);
+    return true;
+}
+
+bool uring_drive_channel::cancel_io(drive_iocb* iocb) {
+    // IOPOLL ring doesn't support async cancel, polled io can only be waited upon
+    if (is_iopoll_io(iocb)) { return false; }
+
+    struct io_uring_sqe* sqe = io_uring_get_sqe(m_ring);
+    if (sqe == nullptr) { return false; }
+
+    // Completion of the cancel request itself carries no iocb, the cancelled io completes with -ECANCELED on its own.
+    // Cancel is submitted and reaped as any other io, so that its completion is accounted for in the CQ room.
+    io_uring_prep_cancel(sqe, (void*)iocb, 0);
+    io_uring_sqe_set_data(sqe, nullptr);
+    ++m_prepared_ios;
+    if (m_track_deadlines) { m_prepared_iocbs.push_back(nullptr); }
+    submit_ios();
+    return true;
+}
+
 ///////////////////////////// UringDriveInterface /////////////////////////////////////////
-UringDriveInterface::UringDriveInterface(const io_interface_comp_cb_t& cb) : KernelDriveInterface(cb) {}
+static bool uring_ops_supported(std::initializer_list< int > ops) {
+    // Probe itself needs kernel 5.6, which is where READ/WRITE/FALLOCATE ops come in anyways
+    struct io_uring_probe* probe = io_uring_get_probe();
+    if (probe == nullptr) { return false; }
+
+    const bool supported{std::all_of(ops.begin(), ops.end(),
+                                     [probe](int op) { return io_uring_opcode_supported(probe, op); })};
+    free(probe);
+    return supported;
+}
+
+UringDriveInterface::UringDriveInterface(const io_interface_comp_cb_t& cb) :
+        KernelDriveInterface(cb),
+        m_plain_rw_supported{uring_ops_supported({IORING_OP_READ, IORING_OP_WRITE})},
+        m_fallocate_supported{uring_ops_supported({IORING_OP_FALLOCATE})},
+        m_file_slot_used(IM_DYNAMIC_CONFIG(uring->registered_files), false) {
+    LOGINFOMOD(iomgr, "Uring drive interface: plain read/write ops supported={}, fallocate op supported={}",
+               m_plain_rw_supported, m_fallocate_supported);
+}
 
 void UringDriveInterface::init_iface_thread_ctx(const io_thread_t& thr) {
-    if (t_uring_ch == nullptr) { t_uring_ch = new uring_drive_channel(this); }
+    if (t_uring_ch != nullptr) { return; }
+
+    t_uring_ch = new uring_drive_channel(this);
+    if (t_uring_ch->m_iopoll && thr->reactor->is_adaptive_loop()) {
+        // Polled ios complete only if we keep polling, so allow backoff only if there are none outstanding
+        thr->reactor->add_backoff_cb([](const io_thread_t& t) -> bool {
+            return (t_uring_ch == nullptr) || (t_uring_ch->m_iopoll_in_flight_ios == 0);
+        });
+    }
+    if (IM_DYNAMIC_CONFIG(io_deadline.enabled)) {
+        const auto interval_ns{IM_DYNAMIC_CONFIG(io_deadline.check_interval_ms) * 1000ul * 1000ul};
+        t_uring_ch->m_track_deadlines = true;
+        t_uring_ch->m_prepared_iocbs.reserve(t_uring_ch->m_max_in_flight_ios);
+        t_uring_ch->m_iopoll_prepared_iocbs.reserve(t_uring_ch->m_max_in_flight_ios);
+        t_uring_ch->m_deadline_timer = iomanager.schedule_thread_timer(
+            interval_ns, interval_ns /* slack */, true /* recurring */, nullptr,
+            [this]([[maybe_unused]] void* cookie) { check_io_deadlines(); });
+    }
 }
 
 void UringDriveInterface::clear_iface_thread_ctx(const io_thread_t& thr) {
     if (t_uring_ch != nullptr) {
+        if (t_uring_ch->m_track_deadlines) { iomanager.cancel_timer(t_uring_ch->m_deadline_timer); }
         delete t_uring_ch;
         t_uring_ch = nullptr;
     }
@@ -181,6 +557,8 @@ io_device_ptr UringDriveInterface::open_dev(const std::string& devname, drive_ty
     iodev->devname = devname;
     iodev->creator = iomanager.am_i_io_reactor() ? iomanager.iothread_self() : nullptr;
     iodev->dtype = dev_type;
+    iodev->uring_file_slot = alloc_file_slot();
+    iodev->uring_iopoll = (dev_type == drive_type::block_nvme) && (oflags & O_DIRECT);
 
     // We don't need to add the device to each thread, because each AioInterface thread context add an
     // event fd and read/write use this device fd to control with iocb.
@@ -194,90 +572,135 @@ void UringDriveInterface::close_dev(const io_device_ptr& iodev) {
     IOInterface::close_dev(iodev);
     // reset counters
     LOGINFOMOD(iomgr, "Device {} close device", iodev->devname);
+
+    const auto slot{iodev->uring_file_slot};
+    if (slot != -1) {
+        // Registered file holds a reference of the device, so drop it from all the rings before we close. Ios which
+        // are in flight hold their own reference, so they are not affected by the unregistration.
+        iomanager.run_on(
+            thread_regex::all_io,
+            [slot]([[maybe_unused]] io_thread_addr_t taddr) {
+                if (t_uring_ch != nullptr) { t_uring_ch->unregister_fixed_file(slot); }
+            },
+            wait_type_t::spin);
+        iodev->uring_file_slot = -1;
+        free_file_slot(slot);
+    }
     // AIO base devices are not added to any poll list, so it can be closed as is.
     close(iodev->fd());
     iodev->clear();
 }
 
+int32_t UringDriveInterface::alloc_file_slot() {
+    std::unique_lock lg(m_file_slots_mtx);
+    for (size_t slot{0}; slot < m_file_slot_used.size(); ++slot) {
+        if (!m_file_slot_used[slot]) {
+            m_file_slot_used[slot] = true;
+            return static_cast< int32_t >(slot);
+        }
+    }
+    return -1;
+}
+
+void UringDriveInterface::free_file_slot(int32_t slot) {
+    std::unique_lock lg(m_file_slots_mtx);
+    m_file_slot_used[slot] = false;
+}
+
 void UringDriveInterface::async_write(IODevice* iodev, const char* data, uint32_t size, uint64_t offset,
                                       uint8_t* cookie, bool part_of_batch) {
-#if LINUX_VERSION_CODE < KERNEL_VERSION(5, 6, 0)
-    std::array< iovec, 1 > iov;
-    iov[0].iov_base = (void*)data;
-    iov[0].iov_len = size;
-
-    async_writev(iodev, iov.data(), 1, size, offset, cookie, part_of_batch);
-#else
-    RELEASE_ASSERT(0, "async_write not expected to arrive here.");
+    if (!t_uring_ch->m_plain_rw) {
+        const iovec iov{const_cast< char* >(data), size};
+        async_writev(iodev, &iov, 1, size, offset, cookie, part_of_batch);
+        return;
+    }
     auto iocb = sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::WRITE, size, offset, cookie);
-    iocb->set_data((char*)data);
-    increment_outstanding_counter(iocb, this);
-    auto sqe = t_uring_ch->get_sqe_or_enqueue(iocb);
-    if (sqe == nullptr) { return; }
-
-    io_uring_prep_write(sqe, iodev->fd(), (const void*)iocb->get_data(), iocb->size, offset);
-    t_uring_ch->submit_if_needed(iocb, sqe, part_of_batch);
-#endif
+    iocb->set_data(const_cast< char* >(data));
+    submit_iocb(iocb, part_of_batch);
 }
 
 void UringDriveInterface::async_writev(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
                                        uint8_t* cookie, bool part_of_batch) {
     auto iocb = sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::WRITE, size, offset, cookie);
     iocb->set_iovs(iov, iovcnt);
-    increment_outstanding_counter(iocb, this);
-    auto sqe = t_uring_ch->get_sqe_or_enqueue(iocb);
-    if (sqe == nullptr) { return; }
+    submit_iocb(iocb, part_of_batch);
+}
 
-    io_uring_prep_writev(sqe, iodev->fd(), iocb->get_iovs(), iocb->iovcnt, offset);
-    t_uring_ch->submit_if_needed(iocb, sqe, part_of_batch);
+void UringDriveInterface::async_writev_durable(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size,
+                                               uint64_t offset, uint8_t* cookie, bool part_of_batch) {
+    auto iocb = sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::WRITE, size, offset, cookie);
+    iocb->set_iovs(iov, iovcnt);
+    iocb->durable = true;
+    submit_iocb(iocb, part_of_batch);
 }
 
 void UringDriveInterface::async_read(IODevice* iodev, char* data, uint32_t size, uint64_t offset, uint8_t* cookie,
                                      bool part_of_batch) {
-#if LINUX_VERSION_CODE < KERNEL_VERSION(5, 6, 0)
-    std::array< iovec, 1 > iov;
-    iov[0].iov_base = data;
-    iov[0].iov_len = size;
-
-    async_readv(iodev, iov.data(), 1, size, offset, cookie, part_of_batch);
-#else
-    RELEASE_ASSERT(0, "async_read not expected to arrive here.");
+    if (!t_uring_ch->m_plain_rw) {
+        const iovec iov{data, size};
+        async_readv(iodev, &iov, 1, size, offset, cookie, part_of_batch);
+        return;
+    }
     auto iocb = sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::READ, size, offset, cookie);
     iocb->set_data(data);
-    increment_outstanding_counter(iocb, this);
-    auto sqe = t_uring_ch->get_sqe_or_enqueue(iocb);
-    if (sqe == nullptr) { return; }
-
-    io_uring_prep_read(sqe, iodev->fd(), (void*)iocb->get_data(), iocb->size, offset);
-    t_uring_ch->submit_if_needed(iocb, sqe, part_of_batch);
-#endif
+    submit_iocb(iocb, part_of_batch);
 }
 
 void UringDriveInterface::async_readv(IODevice* iodev, const iovec* iov, int iovcnt, uint32_t size, uint64_t offset,
                                       uint8_t* cookie, bool part_of_batch) {
     auto iocb = sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::READ, size, offset, cookie);
     iocb->set_iovs(iov, iovcnt);
-    increment_outstanding_counter(iocb, this);
-    auto sqe = t_uring_ch->get_sqe_or_enqueue(iocb);
-    if (sqe == nullptr) { return; }
-
-    io_uring_prep_readv(sqe, iodev->fd(), iocb->get_iovs(), iocb->iovcnt, offset);
-    t_uring_ch->submit_if_needed(iocb, sqe, part_of_batch);
+    submit_iocb(iocb, part_of_batch);
 }
 
 void UringDriveInterface::async_unmap(IODevice* iodev, uint32_t size, uint64_t offset, uint8_t* cookie,
                                       bool part_of_batch) {
-    RELEASE_ASSERT(0, "async_unmap is not supported for uring yet");
+    if (!m_fallocate_supported) {
+        LOGERRORMOD(iomgr, "async_unmap needs uring fallocate op, which kernel doesn't support");
+        io_done(submitting_done_fn(), -EOPNOTSUPP, cookie);
+        return;
+    }
+    submit_iocb(sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::UNMAP, size, offset, cookie),
+                part_of_batch);
 }
 
-void UringDriveInterface::fsync(IODevice* iodev, uint8_t* cookie) {
-    auto iocb = sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::FSYNC, 0, 0, cookie);
+void UringDriveInterface::write_zero(IODevice* iodev, uint64_t size, uint64_t offset, uint8_t* cookie) {
+    if (!m_fallocate_supported) {
+        KernelDriveInterface::write_zero(iodev, size, offset, cookie);
+        return;
+    }
+    submit_iocb(sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::WRITE_ZERO, size, offset, cookie),
+                false /* part_of_batch */);
+}
+
+void UringDriveInterface::async_io(drive_iocb* iocb, bool part_of_batch) {
+    if (!m_fallocate_supported &&
+        ((iocb->op_type == DriveOpType::UNMAP) || (iocb->op_type == DriveOpType::WRITE_ZERO))) {
+        // No fallocate op to issue it on, let the regular api take the fallback
+        DriveInterface::async_io(iocb, part_of_batch);
+        return;
+    }
+    if (!iocb->has_iovs() && iocb->is_rw() && !t_uring_ch->m_plain_rw) {
+        // Kernel can't take the plain buffer, move it to the inline iovec of the iocb itself
+        const iovec iov{iocb->get_data(), iocb->size};
+        iocb->set_iovs(&iov, 1);
+    }
+    iocb->caller_owned = true;
+    submit_iocb(iocb, part_of_batch);
+}
+
+void UringDriveInterface::submit_iocb(drive_iocb* iocb, bool part_of_batch) {
     increment_outstanding_counter(iocb, this);
     auto sqe = t_uring_ch->get_sqe_or_enqueue(iocb);
     if (sqe == nullptr) { return; }
 
-    io_uring_prep_fsync(sqe, iodev->fd(), IORING_FSYNC_DATASYNC);
-    t_uring_ch->submit_if_needed(iocb, sqe, false /* batching */);
+    t_uring_ch->prep_sqe_from_iocb(iocb, sqe);
+    t_uring_ch->submit_if_needed(iocb, sqe, part_of_batch);
+}
+
+void UringDriveInterface::fsync(IODevice* iodev, uint8_t* cookie) {
+    submit_iocb(sisl::ObjectAllocator< drive_iocb >::make_object(iodev, DriveOpType::FSYNC, 0, 0, cookie),
+                false /* part_of_batch */);
 }
 
 void UringDriveInterface::submit_batch() { t_uring_ch->submit_ios(); }
@@ -290,89 +713,151 @@ void UringDriveInterface::on_event_notification(IODevice* iodev, [[maybe_unused]
     handle_completions();
 }
 
-void UringDriveInterface::handle_completions() {
+void UringDriveInterface::handle_completions() { reap_completions(t_uring_ch->m_ring, t_uring_ch->m_cq_overflow); }
+
+void UringDriveInterface::poll_completions() {
+    if (!t_uring_ch->m_iopoll || (t_uring_ch->m_iopoll_in_flight_ios == 0)) { return; }
+
+    // IOPOLL ring posts the completions only when it is polled, so have the kernel poll the devices once without
+    // waiting for any completion, before reaping them.
+    auto* ring{&t_uring_ch->m_iopoll_ring};
+    if (syscall(__NR_io_uring_enter, ring->ring_fd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+        LOGDEBUGMOD(iomgr, "Polling of uring iopoll ring failed, errno={}", errno);
+    }
+    reap_completions(ring, t_uring_ch->m_iopoll_cq_overflow);
+}
+
+void UringDriveInterface::reap_completions(struct io_uring* ring, uint32_t& last_overflow) {
+    std::array< struct io_uring_cqe*, max_reap_batch > cqes;
+    std::array< std::pair< drive_iocb*, int32_t >, max_reap_batch > completions;
+
+    uint32_t count;
     do {
-        struct io_uring_cqe* cqe;
-        int ret = io_uring_peek_cqe(&t_uring_ch->m_ring, &cqe);
-        if (*(t_uring_ch->m_ring.cq.koverflow)) {
+        flush_overflowed_cqes(ring);
+        count = io_uring_peek_batch_cqe(ring, cqes.data(), max_reap_batch);
+
+        const auto overflow{IO_URING_READ_ONCE(*ring->cq.koverflow)};
+        if (overflow != last_overflow) {
+            // These completions are lost for good, their ios can only be caught by the io deadline tracking
             COUNTER_INCREMENT(m_metrics, overflow_errors, 1);
-            COUNTER_INCREMENT(m_metrics, num_of_drops, *(t_uring_ch->m_ring.cq.koverflow));
-            folly::throwSystemError(fmt::format("CQ overflow - number of dropped io requests : {} - {}",
-                                                *(t_uring_ch->m_ring.cq.koverflow), strerror(errno)));
-            break;
+            COUNTER_INCREMENT(m_metrics, num_of_drops, overflow - last_overflow);
+            LOGERRORMOD(iomgr, "Uring fd={} CQ overflow, kernel dropped {} completions", ring->ring_fd,
+                        overflow - last_overflow);
+            last_overflow = overflow;
         }
-        if (ret < 0) {
-            if (ret != -EAGAIN) {
-                COUNTER_INCREMENT(m_metrics, completion_errors, 1);
-                folly::throwSystemError(fmt::format("io_uring_wait_cqe throw error={}", strerror(errno)));
-            } else {
-                LOGTRACEMOD(iomgr, "Received EAGAIN on uring peek cqe");
-            }
-            break;
+        if (count == 0) { break; }
+
+        // Release the cqes to the kernel in one go, before processing them, which could submit more ios
+        for (uint32_t i{0}; i < count; ++i) {
+            completions[i] = std::make_pair((drive_iocb*)io_uring_cqe_get_data(cqes[i]), cqes[i]->res);
         }
-        if (cqe == nullptr) { break; }
-
-        auto iocb = (drive_iocb*)io_uring_cqe_get_data(cqe);
-        iocb->result = cqe->res;
-        io_uring_cqe_seen(&t_uring_ch->m_ring, cqe);
-
-        // Don't access cqe beyond this point.
-        if (iocb->result >= 0) {
-            if (static_cast< uint64_t >(iocb->result) == iocb->size) {
-                // all read buffer is filled by uring;
-                LOGTRACEMOD(iomgr, "Received completion event, iocb={} Result={}", (void*)iocb, iocb->result);
-                complete_io(iocb);
-            } else {
-                // ***** Paritial Read Handling ******** //
-                LOGDEBUGMOD(iomgr, "Received completion event with partial result, iocb={} size={} Result={}, retry={}",
-                            (void*)iocb, iocb->size, iocb->result, iocb->resubmit_cnt);
-                if (iocb->part_read_resubmit_cnt++ > IM_DYNAMIC_CONFIG(partial_read_max_resubmit_cnt)) {
-                    LOGMSG_ASSERT(false, "Don't expect partial read to exceed retry limit={}",
-                                  IM_DYNAMIC_CONFIG(partial_read_max_resubmit_cnt));
-
-                    // in production, keep retrying until we get all the data;
-                }
-
-                COUNTER_INCREMENT(m_metrics, retry_on_partial_read, 1);
-                iocb->update_iovs_on_partial_result();
-                // retry I/O with remaining unset data;
-                t_uring_ch->m_iocb_waitq.push(iocb);
-                --(t_uring_ch->m_in_flight_ios);
-            }
+        io_uring_cq_advance(ring, count);
+
+        for (uint32_t i{0}; i < count; ++i) {
+            on_io_completion(completions[i].first, completions[i].second);
+        }
+    } while (count == max_reap_batch);
+
+    // Submissions refused earlier (CQ overflow backpressure), could go through now
+    t_uring_ch->submit_ios();
+}
+
+void UringDriveInterface::on_io_completion(drive_iocb* iocb, int32_t res) {
+    if (iocb == nullptr) {
+        // Completion of a cancel request issued for a timed out io
+        t_uring_ch->on_io_reaped(false /* iopoll_io */);
+        if (res < 0) {
+            LOGERRORMOD(iomgr, "Unable to cancel the timed out io, error={}", res);
+            COUNTER_INCREMENT(m_metrics, io_cancel_failures, 1);
+        }
+        return;
+    }
+
+    iocb->result = res;
+    if (iocb->result >= 0) {
+        if ((static_cast< uint64_t >(iocb->result) == iocb->size) || !iocb->is_rw()) {
+            // all read buffer is filled by uring;
+            LOGTRACEMOD(iomgr, "Received completion event, iocb={} Result={}", (void*)iocb, iocb->result);
+            complete_io(iocb);
         } else {
-            LOGERRORMOD(iomgr, "Error in completion of io, iocb={}, result={}, retry={}", (void*)iocb, iocb->result,
-                        iocb->resubmit_cnt);
-            if ((iocb->result != -EAGAIN) && iocb->resubmit_cnt++ > IM_DYNAMIC_CONFIG(max_resubmit_cnt)) {
-                // EAGAIN won't increase resubmit_cnt;
-                DEBUG_ASSERT(false, "Don't expect op={} retry exceed limit={}", iocb->op_type,
-                             IM_DYNAMIC_CONFIG(max_resubmit_cnt));
-                complete_io(iocb);
-            } else {
-                // if disk driver return EAGAIN, keep retrying unconditionally;
-                // Retry IO by pushing it to waitq which will get scheduled later.
-                t_uring_ch->m_iocb_waitq.push(iocb);
+            // ***** Paritial Read Handling ******** //
+            LOGDEBUGMOD(iomgr, "Received completion event with partial result, iocb={} size={} Result={}, retry={}",
+                        (void*)iocb, iocb->size, iocb->result, iocb->resubmit_cnt);
+            if (iocb->part_read_resubmit_cnt++ > IM_DYNAMIC_CONFIG(partial_read_max_resubmit_cnt)) {
+                LOGMSG_ASSERT(false, "Don't expect partial read to exceed retry limit={}",
+                              IM_DYNAMIC_CONFIG(partial_read_max_resubmit_cnt));
+
+                // in production, keep retrying until we get all the data;
             }
+
+            COUNTER_INCREMENT(m_metrics, retry_on_partial_read, 1);
+            iocb->update_iovs_on_partial_result();
+            // retry I/O with remaining unset data;
+            t_uring_ch->m_iocb_waitq.push_back(iocb);
+            t_uring_ch->on_io_reaped(t_uring_ch->is_iopoll_io(iocb));
+        }
+    } else {
+        LOGERRORMOD(iomgr, "Error in completion of io, iocb={}, result={}, retry={}", (void*)iocb, iocb->result,
+                    iocb->resubmit_cnt);
+        if (iocb->deadline_hook.timed_out) {
+            // Most likely cancelled by us, retrying would defeat the purpose
+            complete_io(iocb);
+        } else if ((iocb->result == -EOPNOTSUPP) || (iocb->result == -EINVAL)) {
+            // Op (e.g. unmap) not supported by the device or misaligned, retrying wouldn't change it
+            complete_io(iocb);
+        } else if ((iocb->result != -EAGAIN) && iocb->resubmit_cnt++ > IM_DYNAMIC_CONFIG(max_resubmit_cnt)) {
+            // EAGAIN won't increase resubmit_cnt;
+            DEBUG_ASSERT(false, "Don't expect op={} retry exceed limit={}", iocb->op_type,
+                         IM_DYNAMIC_CONFIG(max_resubmit_cnt));
+            complete_io(iocb);
+        } else {
+            // if disk driver return EAGAIN, keep retrying unconditionally;
+            // Retry IO by pushing it to waitq which will get scheduled later.
+            t_uring_ch->m_iocb_waitq.push_back(iocb);
+            t_uring_ch->on_io_reaped(t_uring_ch->is_iopoll_io(iocb));
         }
-        t_uring_ch->drain_waitq();
-    } while (true);
+    }
+    t_uring_ch->drain_waitq();
 }
 
-void UringDriveInterface::complete_io(drive_iocb* iocb) {
+void UringDriveInterface::complete_io(drive_iocb* iocb, bool in_flight) {
     const auto cookie = iocb->user_cookie;
     const auto iocb_result = iocb->result;
+    const auto done_fn = iocb->done_fn;
+
+    const bool iopoll_io{t_uring_ch->is_iopoll_io(iocb)};
 
     decrement_outstanding_counter(iocb, this);
-    sisl::ObjectAllocator< drive_iocb >::deallocate(iocb);
+    if (!iocb->caller_owned) { sisl::ObjectAllocator< drive_iocb >::deallocate(iocb); }
 
-    --(t_uring_ch->m_in_flight_ios);
+    if (in_flight) { t_uring_ch->on_io_reaped(iopoll_io); }
 
-    if (m_comp_cb) {
-        auto res = (iocb_result > 0) ? 0 : iocb_result;
-        m_comp_cb(res, (uint8_t*)cookie);
+    io_done(done_fn, (iocb_result > 0) ? 0 : iocb_result, (uint8_t*)cookie);
+}
+
+void UringDriveInterface::check_io_deadlines() {
+    const auto timeout_ms{IM_DYNAMIC_CONFIG(io_deadline.timeout_ms)};
+    const auto cutoff{Clock::now() - std::chrono::milliseconds(timeout_ms)};
+
+    drive_iocb* iocb;
+    while ((iocb = t_uring_ch->m_deadline_tracker.pop_expired(cutoff)) != nullptr) {
+        const auto outstanding_ms{get_elapsed_time_ms(iocb->deadline_hook.submit_time)};
+        COUNTER_INCREMENT(m_metrics, io_timeouts, 1);
+        LOGERRORMOD(iomgr, "IO outstanding for {} ms, beyond the timeout={} ms, cancelling it, iocb={}",
+                    outstanding_ms, timeout_ms, iocb->to_string());
+
+        if (m_io_timeout_cb) { m_io_timeout_cb((uint8_t*)iocb->user_cookie, outstanding_ms); }
+        if (t_uring_ch->unlink_waitq(iocb)) {
+            // Waiting to be resubmitted (partial read or retry on error), kernel has nothing of it to cancel
+            iocb->result = -ETIMEDOUT;
+            complete_io(iocb, false /* in_flight */);
+        } else if (!t_uring_ch->cancel_io(iocb)) {
+            COUNTER_INCREMENT(m_metrics, io_cancel_failures, 1);
+        }
     }
 }
 
-void UringDriveInterface::increment_outstanding_counter(const drive_iocb* iocb, UringDriveInterface* iface) {
+void UringDriveInterface::increment_outstanding_counter(drive_iocb* iocb, UringDriveInterface* iface) {
     /* update outstanding counters */
     switch (iocb->op_type) {
     case DriveOpType::READ:
@@ -384,13 +869,20 @@ void UringDriveInterface::increment_outstanding_counter(const drive_iocb* iocb,
     case DriveOpType::FSYNC:
         COUNTER_INCREMENT(iface->get_metrics(), outstanding_fsync_cnt, 1);
         break;
+    case DriveOpType::UNMAP:
+        COUNTER_INCREMENT(iface->get_metrics(), outstanding_unmap_cnt, 1);
+        break;
+    case DriveOpType::WRITE_ZERO:
+        COUNTER_INCREMENT(iface->get_metrics(), outstanding_write_zero_cnt, 1);
+        break;
     default:
         LOGDFATAL("Invalid operation type {}", iocb->op_type);
     }
     ++(iomanager.this_thread_metrics().outstanding_ops);
+    if (iomanager.this_reactor()) { iomanager.this_reactor()->drive_io_submitted(); }
 }
 
-void UringDriveInterface::decrement_outstanding_counter(const drive_iocb* iocb, UringDriveInterface* iface) {
+void UringDriveInterface::decrement_outstanding_counter(drive_iocb* iocb, UringDriveInterface* iface) {
     /* decrement */
     switch (iocb->op_type) {
     case DriveOpType::READ:
@@ -402,9 +894,19 @@ void UringDriveInterface::decrement_outstanding_counter(const drive_iocb* iocb,
     case DriveOpType::FSYNC:
         COUNTER_DECREMENT(iface->get_metrics(), outstanding_fsync_cnt, 1);
         break;
+    case DriveOpType::UNMAP:
+        COUNTER_DECREMENT(iface->get_metrics(), outstanding_unmap_cnt, 1);
+        break;
+    case DriveOpType::WRITE_ZERO:
+        COUNTER_DECREMENT(iface->get_metrics(), outstanding_write_zero_cnt, 1);
+        break;
     default:
         LOGDFATAL("Invalid operation type {}", iocb->op_type);
     }
     --(iomanager.this_thread_metrics().outstanding_ops);
+    if (iomanager.this_reactor()) { iomanager.this_reactor()->drive_io_completed(); }
+
+    const auto stuck_ms{t_uring_ch->m_deadline_tracker.remove(iocb)};
+    if (stuck_ms) { HISTOGRAM_OBSERVE(iface->get_metrics(), stuck_io_duration_ms, stuck_ms); }
 }
 } // namespace iomgr
@@ -0,0 +1,126 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <sys/mman.h>
+
+#include "iobuf_arena.hpp"
+
+namespace iomgr {
+static inline uint64_t make_head(uint32_t slot, uint32_t tag) { return (static_cast< uint64_t >(tag) << 32) | slot; }
+static inline uint32_t head_slot(uint64_t head) { return static_cast< uint32_t >(head); }
+static inline uint32_t head_tag(uint64_t head) { return static_cast< uint32_t >(head >> 32); }
+
+iobuf_arena::iobuf_arena(size_t size) {
+    m_num_chunks = std::max(size / chunk_size, 1ul);
+
+    // Over map by a chunk so that chunks (and hence all the buffers) are naturally aligned
+    m_mapping_size = (m_num_chunks + 1) * chunk_size;
+    m_mapping = ::mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_mapping == MAP_FAILED) {
+        m_mapping = nullptr;
+        throw std::system_error(errno, std::generic_category(), "Unable to map the io buffer arena");
+    }
+    const auto addr{reinterpret_cast< uintptr_t >(m_mapping)};
+    m_base = reinterpret_cast< uint8_t* >((addr + chunk_size - 1) & ~(chunk_size - 1));
+    m_end = m_base + (m_num_chunks * chunk_size);
+    m_iov.iov_base = m_base;
+    m_iov.iov_len = m_num_chunks * chunk_size;
+
+    m_chunk_class = std::make_unique< std::atomic< uint8_t >[] >(m_num_chunks);
+    for (size_t i{0}; i < m_num_chunks; ++i) {
+        m_chunk_class[i].store(invalid_class, std::memory_order_relaxed);
+    }
+    for (auto& h : m_free_head) {
+        h.store(make_head(null_slot, 0), std::memory_order_relaxed);
+    }
+}
+
+iobuf_arena::~iobuf_arena() {
+    if (m_mapping) { ::munmap(m_mapping, m_mapping_size); }
+}
+
+uint8_t* iobuf_arena::alloc(size_t align, size_t size) {
+    const auto cls{size_class(std::max(size, align))};
+    if (cls == invalid_class) { return nullptr; }
+
+    auto slot{pop(cls)};
+    while (slot == null_slot) {
+        if (!carve_chunk(cls)) { return nullptr; }
+        slot = pop(cls);
+    }
+    return buf_of(slot);
+}
+
+void iobuf_arena::free(uint8_t* buf) {
+    const auto cls{m_chunk_class[(buf - m_base) / chunk_size].load(std::memory_order_acquire)};
+    const auto slot{slot_of(buf)};
+    push(cls, slot, slot);
+}
+
+size_t iobuf_arena::buf_size(const uint8_t* buf) const {
+    return class_size(m_chunk_class[(buf - m_base) / chunk_size].load(std::memory_order_acquire));
+}
+
+uint32_t iobuf_arena::size_class(size_t size) {
+    if (size > max_buf_size) { return invalid_class; }
+    if (size <= min_buf_size) { return 0; }
+    return static_cast< uint32_t >(64 - __builtin_clzll(size - 1)) - 12; // log2(ceil_pow2(size)) - log2(4096)
+}
+
+// Push a linked run of slots [first ... last] (already linked through their first word) to the class free stack
+void iobuf_arena::push(uint32_t cls, uint32_t first, uint32_t last) {
+    auto& head{m_free_head[cls]};
+    auto old_head{head.load(std::memory_order_relaxed)};
+    do {
+        const uint32_t next{head_slot(old_head)};
+        std::memcpy(buf_of(last), &next, sizeof(uint32_t));
+    } while (!head.compare_exchange_weak(old_head, make_head(first, head_tag(old_head) + 1),
+                                         std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint32_t iobuf_arena::pop(uint32_t cls) {
+    auto& head{m_free_head[cls]};
+    auto old_head{head.load(std::memory_order_acquire)};
+    uint32_t next;
+    do {
+        if (head_slot(old_head) == null_slot) { return null_slot; }
+        // Slot could be popped and reused by someone else meanwhile, then the tag makes the CAS fail. Memory stays
+        // mapped for the lifetime of the arena, so the read itself is always safe
+        std::memcpy(&next, buf_of(head_slot(old_head)), sizeof(uint32_t));
+    } while (!head.compare_exchange_weak(old_head, make_head(next, head_tag(old_head) + 1),
+                                         std::memory_order_acquire, std::memory_order_acquire));
+    return head_slot(old_head);
+}
+
+bool iobuf_arena::carve_chunk(uint32_t cls) {
+    const auto chunk{m_next_chunk.fetch_add(1, std::memory_order_relaxed)};
+    if (chunk >= m_num_chunks) { return false; }
+    m_chunk_class[chunk].store(static_cast< uint8_t >(cls), std::memory_order_release);
+
+    // Link all buffers of the chunk and push them in one go
+    const auto step{static_cast< uint32_t >(class_size(cls) / min_buf_size)};
+    const auto first{static_cast< uint32_t >(chunk * (chunk_size / min_buf_size))};
+    const auto last{first + static_cast< uint32_t >(chunk_size / min_buf_size) - step};
+    for (auto s{first}; s < last; s += step) {
+        const uint32_t next{s + step};
+        std::memcpy(buf_of(s), &next, sizeof(uint32_t));
+    }
+    push(cls, first, last);
+    return true;
+}
+} // namespace iomgr
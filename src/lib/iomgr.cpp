@@ -19,6 +19,7 @@
 #include <functional>
 #include <limits>
 #include <random>
+#include <system_error>
 #include <thread>
 #include <vector>
 
@@ -53,6 +54,7 @@
 #include "iomgr_config.hpp"
 #include "reactor_epoll.hpp"
 #include "reactor_spdk.hpp"
+#include "reactor_uring.hpp"
 
 // Must be included after sisl headers to avoid macro definition clash
 extern "C" {
@@ -77,7 +79,15 @@ SISL_OPTION_GROUP(iomgr,
                    ::cxxopts::value< uint32_t >(), "count"),
                   (encryption, "", "encryption", "Turn on encryption", cxxopts::value< bool >(), "true or false"),
                   (authorization, "", "authorization", "Turn on authorization", cxxopts::value< bool >(),
-                   "true or false"))
+                   "true or false"),
+                  (uring_reactor, "", "uring_reactor", "Run interrupt reactors on io_uring instead of epoll",
+                   cxxopts::value< bool >(), "true or false"),
+                  (uring_sqpoll, "", "uring_sqpoll", "Submit uring drive ios through a kernel SQ poll thread",
+                   cxxopts::value< bool >(), "true or false"),
+                  (uring_plain_rw, "", "uring_plain_rw", "Issue single buffer uring ios as READ/WRITE (not vectored)",
+                   cxxopts::value< bool >(), "true or false"),
+                  (force_aio, "", "force_aio", "Issue drive ios through aio even if io_uring is supported",
+                   cxxopts::value< bool >(), "true or false"))
 
 namespace iomgr {
 
@@ -187,8 +197,28 @@ void IOManager::start(size_t const num_threads, bool is_spdk, const thread_state
         sisl::AlignedAllocator::instance().set_allocator(std::move(new IOMgrAlignedAllocImpl()));
     }
 
-    m_is_uring_capable = check_uring_capability();
-    LOGINFOMOD(iomgr, "System has uring_capability={}", m_is_uring_capable);
+    m_is_uring_capable = !IM_DYNAMIC_CONFIG(aio.forced) && check_uring_capability();
+    LOGINFOMOD(iomgr, "System has uring_capability={}, aio forced={}", m_is_uring_capable,
+               IM_DYNAMIC_CONFIG(aio.forced));
+
+    // Arena is created once and kept across restarts, since buffers allocated from it could outlive the stop
+    auto arena_mb{IM_DYNAMIC_CONFIG(iomem.fixed_buf_arena_mb)};
+    if (m_is_uring_capable && !is_spdk && (arena_mb != 0) && !m_fixed_buf_arena) {
+        if (arena_mb > iobuf_arena::max_registered_mb) {
+            // Arena is registered as a single buffer, which kernel rejects if it is above 1GB
+            LOGWARNMOD(iomgr, "Fixed io buffer arena size={} MB is above the registered buffer limit, clamped to {} MB",
+                       arena_mb, iobuf_arena::max_registered_mb);
+            arena_mb = iobuf_arena::max_registered_mb;
+        }
+        try {
+            m_fixed_buf_arena = std::make_unique< iobuf_arena >(static_cast< size_t >(arena_mb) * 1024 * 1024);
+            m_fixed_buf_arena_enabled.store(true, std::memory_order_release);
+            LOGINFOMOD(iomgr, "Created fixed io buffer arena of size={} MB", m_fixed_buf_arena->size() / (1024 * 1024));
+        } catch (const std::system_error& e) {
+            LOGWARNMOD(iomgr, "Unable to create fixed io buffer arena of size={} MB, error={}, continuing without it",
+                       arena_mb, e.what());
+        }
+    }
 
     // Create all in-built interfaces here
     set_state(iomgr_state::interface_init);
@@ -253,9 +283,6 @@ void IOManager::start(size_t const num_threads, bool is_spdk, const thread_state
     // Notify all the reactors that they are ready to make callback about thread started
     iomanager.run_on(thread_regex::all_io,
                      [this](io_thread_addr_t taddr) { iomanager.this_reactor()->notify_thread_state(true); });
-
-    m_io_wd = std::make_unique< IOWatchDog >();
-
 } // namespace iomgr
 
 static enum spdk_log_level to_spdk_log_level(spdlog::level::level_enum lvl) {
@@ -599,6 +626,9 @@ void IOManager::_run_io_loop(int iomgr_slot_num, loop_type_t loop_type, const st
     if (m_is_spdk && (loop_type & TIGHT_LOOP)) {
         ltype = (loop_type & ~INTERRUPT_LOOP);
         reactor = std::make_shared< IOReactorSPDK >();
+    } else if (m_is_uring_capable && ((loop_type & URING_LOOP) || IM_DYNAMIC_CONFIG(uring.reactor_enabled))) {
+        ltype = (loop_type & ~TIGHT_LOOP) | INTERRUPT_LOOP | URING_LOOP;
+        reactor = std::make_shared< IOReactorUring >();
     } else {
         ltype = (loop_type & ~TIGHT_LOOP) | INTERRUPT_LOOP;
         reactor = std::make_shared< IOReactorEPoll >();
@@ -655,6 +685,14 @@ int IOManager::run_on(const io_thread_t& thread, spdk_msg_signature_t fn, void*
     return 1;
 }
 
+// Msg can be shared by its destinations only if it is a run method of the internal module whose closure is invoked as
+// const. Msgs of other modules are handled by the handlers written for a msg each and non const closures (mutable
+// lambdas) carry a state, so they get a clone per thread.
+bool IOManager::can_share_msg(const iomgr_msg* msg) const {
+    return (msg->m_dest_module == m_internal_msg_module_id) && (msg->m_type == iomgr_msg_type::RUN_METHOD) &&
+        msg->method_data().is_const_invocable();
+}
+
 int IOManager::multicast_msg(thread_regex r, iomgr_msg* msg) {
     int sent_to = 0;
     bool cloned = false;
@@ -662,6 +700,7 @@ int IOManager::multicast_msg(thread_regex r, iomgr_msg* msg) {
     io_thread_addr_t min_thread = -1U;
     IOReactor* min_reactor = nullptr;
     IOReactor* sender_reactor = iomanager.this_reactor();
+    const bool pick_least_busy{(r == thread_regex::least_busy_worker) || (r == thread_regex::least_busy_user)};
 
     static thread_local std::random_device s_rd{};
     static thread_local std::default_random_engine s_re{s_rd()};
@@ -670,38 +709,75 @@ int IOManager::multicast_msg(thread_regex r, iomgr_msg* msg) {
         // Send to any random iomgr created io thread
         auto& reactor = m_worker_reactors[m_rand_worker_distribution(s_re)];
         sent_to = reactor->deliver_msg(reactor->select_thread()->thread_addr, msg, sender_reactor) ? 1 : 0;
+    } else if (r == thread_regex::least_busy_worker) {
+        // Selector picks among the workers without walking all of them
+        auto* reactor = m_worker_selector.select(m_worker_reactors);
+        if (reactor) {
+            sent_to = reactor->deliver_msg(reactor->select_thread()->thread_addr, msg, sender_reactor) ? 1 : 0;
+        }
     } else {
-        _pick_reactors(r, [&](IOReactor* reactor, bool is_last_thread) {
-            if (reactor && reactor->is_io_reactor()) {
-                for (auto& thr : reactor->io_threads()) {
-                    if (match_regex(r, thr)) {
-                        if ((r == thread_regex::least_busy_worker) || (r == thread_regex::least_busy_user)) {
-                            if (reactor->m_metrics->outstanding_ops < min_cnt) {
-                                min_thread = thr->thread_addr;
-                                min_cnt = reactor->m_metrics->outstanding_ops;
-                                min_reactor = reactor;
-                            }
-                        } else {
-                            auto* new_msg = msg->clone();
-                            if (reactor->deliver_msg(thr->thread_addr, new_msg, sender_reactor)) {
-                                cloned = true;
-                                ++sent_to;
+        // Instead of a clone per thread, the same msg is delivered to all single threaded reactors (which is always at
+        // thread address 0), if it can be run by all of them at once. Sender holds one reference till it delivered to
+        // all of them.
+        const bool share{!pick_least_busy && can_share_msg(msg)};
+        if (share) {
+            msg->m_is_broadcast = true;
+            msg->m_dest_thread = 0;
+            msg->m_broadcast_refs.set(1);
+        }
+
+        // Clones for the multi threaded reactors are all taken before the msg is delivered shared to anyone, so that
+        // clone doesn't copy the closure while some destination is running it
+        for (const bool shared_pass : {false, true}) {
+            if (shared_pass && !share) { break; }
+            _pick_reactors(r, [&](IOReactor* reactor, bool is_last_thread) {
+                if (reactor && reactor->is_io_reactor() &&
+                    (shared_pass == (share && (reactor->io_threads().size() == 1)))) {
+                    for (auto& thr : reactor->io_threads()) {
+                        if (match_regex(r, thr)) {
+                            if (pick_least_busy) {
+                                const auto score{reactor->load().score()};
+                                if (score < min_cnt) {
+                                    min_thread = thr->thread_addr;
+                                    min_cnt = score;
+                                    min_reactor = reactor;
+                                }
+                            } else if (shared_pass) {
+                                msg->m_broadcast_refs.increment(1);
+                                if (reactor->deliver_msg(thr->thread_addr, msg, sender_reactor)) {
+                                    ++sent_to;
+                                } else {
+                                    msg->m_broadcast_refs.decrement(1);
+                                }
                             } else {
-                                // failed to deliver cleanup resources
-                                iomgr_msg::free(new_msg);
+                                auto* new_msg = msg->clone();
+                                if (reactor->deliver_msg(thr->thread_addr, new_msg, sender_reactor)) {
+                                    cloned = true;
+                                    ++sent_to;
+                                } else {
+                                    // failed to deliver cleanup resources
+                                    iomgr_msg::free(new_msg);
+                                }
                             }
                         }
                     }
                 }
-            }
 
-            if (is_last_thread && min_reactor) {
-                if (min_reactor->deliver_msg(min_thread, msg, sender_reactor)) ++sent_to;
-            }
-        });
+                if (is_last_thread && min_reactor) {
+                    if (min_reactor->deliver_msg(min_thread, msg, sender_reactor)) ++sent_to;
+                }
+            });
+        }
     }
 
-    if ((cloned || (sent_to == 0)) && !msg->is_sync_msg()) { iomgr_msg::free(msg); }
+    if (!msg->is_sync_msg()) {
+        if (msg->m_is_broadcast) {
+            // Drop the sender reference, the last one to complete frees it
+            iomgr_msg::completed(msg);
+        } else if (cloned || (sent_to == 0)) {
+            iomgr_msg::free(msg);
+        }
+    }
     return sent_to;
 }
 
@@ -773,6 +849,23 @@ bool IOManager::send_msg(const io_thread_t& to_thread, iomgr_msg* msg) {
     return ret;
 }
 
+int IOManager::send_msgs(const io_thread_t& to_thread, msg_batch_t&& msgs) {
+    if (msgs.empty()) { return 0; }
+    if (msgs.size() == 1) { return send_msg(to_thread, msgs[0]) ? 1 : 0; }
+
+    // Wrap all messages in a single carrier message, so that it takes one enqueue and one wakeup of the destination
+    for (auto& msg : msgs) {
+        msg->m_dest_thread = to_thread->thread_addr;
+        msg->set_pending();
+    }
+    const auto count{static_cast< int >(msgs.size())};
+
+    // If not sent, the carrier is freed by send_msg, which in turn completes all the messages it carried
+    return send_msg(to_thread, iomgr_msg::create(iomgr_msg_type::MSG_BATCH, m_internal_msg_module_id, std::move(msgs)))
+        ? count
+        : 0;
+}
+
 bool IOManager::send_msg_and_wait(const io_thread_t& to_thread, const std::shared_ptr< sync_msg_base >& smsg) {
     const auto sent{send_msg(to_thread, smsg->base_msg())};
     if (sent) { smsg->wait(); }
@@ -810,11 +903,24 @@ void spin_iomgr_msg::wait() {
 
 timer_handle_t IOManager::schedule_thread_timer(uint64_t nanos_after, bool recurring, void* cookie,
                                                 timer_callback_t&& timer_fn) {
-    return this_reactor()->m_thread_timer->schedule(nanos_after, recurring, cookie, std::move(timer_fn));
+    return schedule_thread_timer(nanos_after, 0 /* slack_nanos */, recurring, cookie, std::move(timer_fn));
+}
+
+timer_handle_t IOManager::schedule_thread_timer(uint64_t nanos_after, uint64_t slack_nanos, bool recurring,
+                                                void* cookie, timer_callback_t&& timer_fn) {
+    return this_reactor()->m_thread_timer->schedule(nanos_after, recurring, cookie, std::move(timer_fn),
+                                                    false /* wait_to_schedule */, slack_nanos);
 }
 
 timer_handle_t IOManager::schedule_global_timer(uint64_t nanos_after, bool recurring, void* cookie, thread_regex r,
                                                 timer_callback_t&& timer_fn, bool wait_to_schedule) {
+    return schedule_global_timer(nanos_after, 0 /* slack_nanos */, recurring, cookie, r, std::move(timer_fn),
+                                 wait_to_schedule);
+}
+
+timer_handle_t IOManager::schedule_global_timer(uint64_t nanos_after, uint64_t slack_nanos, bool recurring,
+                                                void* cookie, thread_regex r, timer_callback_t&& timer_fn,
+                                                bool wait_to_schedule) {
     timer* t = nullptr;
     if (r == thread_regex::all_worker) {
         t = m_global_worker_timer.get();
@@ -825,7 +931,7 @@ timer_handle_t IOManager::schedule_global_timer(uint64_t nanos_after, bool recur
         return null_timer_handle;
     }
 
-    return t->schedule(nanos_after, recurring, cookie, std::move(timer_fn), wait_to_schedule);
+    return t->schedule(nanos_after, recurring, cookie, std::move(timer_fn), wait_to_schedule, slack_nanos);
 }
 
 void IOManager::set_poll_interval(const int interval) { this_reactor()->set_poll_interval(interval); }
@@ -873,6 +979,63 @@ IOReactor* IOManager::round_robin_reactor() const {
     } while (true);
 }
 
+int IOManager::run_on_any_worker(run_method_t&& fn) {
+    auto* task = stealable_task::create(std::move(fn));
+    auto* reactor = this_reactor();
+    if (reactor && reactor->m_task_q) {
+        reactor->enqueue_task(task);
+        return 1;
+    }
+
+    // Not a worker thread, hand it over to a worker which queues it up locally
+    const auto sent{run_on(thread_regex::least_busy_worker, [task]([[maybe_unused]] io_thread_addr_t taddr) {
+        iomanager.this_reactor()->enqueue_task(task);
+    })};
+    if (sent == 0) { stealable_task::free(task); }
+    return sent;
+}
+
+void IOManager::wake_task_thief(IOReactor* victim) {
+    static thread_local std::random_device s_rd{};
+    static thread_local std::default_random_engine s_re{s_rd()};
+
+    const auto nworkers{m_worker_reactors.size()};
+    if (nworkers < 2) { return; }
+
+    // Any other worker which is not already busy would do, it steals as part of running its own tasks
+    std::uniform_int_distribution< size_t > dist{0, nworkers - 1};
+    const auto start{dist(s_re)};
+    for (size_t i{0}; i < nworkers; ++i) {
+        auto* reactor = m_worker_reactors[(start + i) % nworkers].get();
+        if ((reactor == nullptr) || (reactor == victim) || !reactor->is_io_reactor()) { continue; }
+        if (reactor->load().queued_work() != 0) { continue; }
+
+        // Msg is only to wake up the reactor and has nothing to run. Stealing has to wait till the reactor is done
+        // with the msgs (including this one) and runs its tasks from listen_once, since it steals only when it has no
+        // queued work of its own.
+        run_on(reactor->iothread_self(), []([[maybe_unused]] io_thread_addr_t taddr) {});
+        return;
+    }
+}
+
+stealable_task* IOManager::steal_task(IOReactor* thief) {
+    static thread_local std::random_device s_rd{};
+    static thread_local std::default_random_engine s_re{s_rd()};
+
+    const auto nworkers{m_worker_reactors.size()};
+    if (nworkers < 2) { return nullptr; }
+
+    // Start from a random victim, so that the thieves spread out
+    std::uniform_int_distribution< size_t > dist{0, nworkers - 1};
+    const auto start{dist(s_re)};
+    for (size_t i{0}; i < nworkers; ++i) {
+        auto* victim = m_worker_reactors[(start + i) % nworkers].get();
+        if ((victim == nullptr) || (victim == thief) || !victim->m_task_q) { continue; }
+        if (auto* task = victim->m_task_q->steal()) { return task; }
+    }
+    return nullptr;
+}
+
 msg_module_id_t IOManager::register_msg_module(const msg_handler_t& handler) {
     std::unique_lock lk(m_msg_hdlrs_mtx);
     DEBUG_ASSERT_LT(m_msg_handlers_count, m_msg_handlers.size(), "More than expected msg modules registered");
@@ -926,6 +1089,8 @@ bool IODevice::is_my_thread_scope() const {
 
 void IODevice::clear() {
     dev = -1;
+    uring_file_slot = -1;
+    uring_iopoll = false;
     tinfo = nullptr;
     cookie = nullptr;
     m_iodev_thread_ctx.clear();
@@ -934,23 +1099,66 @@ void IODevice::clear() {
 DriveInterface* IODevice::drive_interface() { return static_cast< DriveInterface* >(io_interface); }
 
 /////////////////// IOManager Memory Management APIs ///////////////////////////////////
+// Buffers served from the fixed buf arena are counted in the buftag metrics like any other iobuf. The arena itself is
+// mapped upfront and never returned to the system, so its frees don't drive the io memory limit release check.
 uint8_t* IOManager::iobuf_alloc(size_t align, size_t size, const sisl::buftag tag) {
+    if (m_fixed_buf_arena && m_fixed_buf_arena_enabled.load(std::memory_order_relaxed)) {
+        auto buf{m_fixed_buf_arena->alloc(align, size)};
+        if (buf) {
+#ifdef _PRERELEASE
+            sisl::AlignedAllocator::metrics().increment(tag, m_fixed_buf_arena->buf_size(buf));
+#endif
+            return buf;
+        }
+    }
     return sisl::AlignedAllocator::allocator().aligned_alloc(align, size, tag);
 }
 
 void IOManager::iobuf_free(uint8_t* buf, const sisl::buftag tag) {
+    if (m_fixed_buf_arena && m_fixed_buf_arena->owns(buf)) {
+#ifdef _PRERELEASE
+        sisl::AlignedAllocator::metrics().decrement(tag, m_fixed_buf_arena->buf_size(buf));
+#endif
+        m_fixed_buf_arena->free(buf);
+        return;
+    }
     sisl::AlignedAllocator::allocator().aligned_free(buf, tag);
 }
 
 uint8_t* IOManager::iobuf_pool_alloc(size_t align, size_t size, const sisl::buftag tag) {
+    if (m_fixed_buf_arena && m_fixed_buf_arena_enabled.load(std::memory_order_relaxed)) {
+        auto buf{m_fixed_buf_arena->alloc(align, size)};
+        if (buf) {
+#ifdef _PRERELEASE
+            sisl::AlignedAllocator::metrics().increment(tag, m_fixed_buf_arena->buf_size(buf));
+#endif
+            return buf;
+        }
+    }
     return sisl::AlignedAllocator::allocator().aligned_pool_alloc(align, size, tag);
 }
 
 void IOManager::iobuf_pool_free(uint8_t* buf, size_t size, const sisl::buftag tag) {
+    if (m_fixed_buf_arena && m_fixed_buf_arena->owns(buf)) {
+#ifdef _PRERELEASE
+        sisl::AlignedAllocator::metrics().decrement(tag, m_fixed_buf_arena->buf_size(buf));
+#endif
+        m_fixed_buf_arena->free(buf);
+        return;
+    }
     sisl::AlignedAllocator::allocator().aligned_pool_free(buf, size, tag);
 }
 
-size_t IOManager::iobuf_size(uint8_t* buf) const { return sisl::AlignedAllocator::allocator().buf_size(buf); }
+void IOManager::disable_fixed_buf_arena() {
+    if (m_fixed_buf_arena_enabled.exchange(false, std::memory_order_acq_rel)) {
+        LOGWARNMOD(iomgr, "Fixed io buffer arena could not be registered, io buffers are no longer allocated from it");
+    }
+}
+
+size_t IOManager::iobuf_size(uint8_t* buf) const {
+    if (m_fixed_buf_arena && m_fixed_buf_arena->owns(buf)) { return m_fixed_buf_arena->buf_size(buf); }
+    return sisl::AlignedAllocator::allocator().buf_size(buf);
+}
 
 void IOManager::set_io_memory_limit(const size_t limit) {
     m_mem_size_limit = limit;
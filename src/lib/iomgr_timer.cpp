@@ -14,6 +14,7 @@
  **************************************************************************/
 #include "iomgr.hpp"
 #include "iomgr_timer.hpp"
+#include "iomgr_config.hpp"
 #include "reactor.hpp"
 #include <unordered_set>
 
@@ -42,6 +43,9 @@ timer_epoll::timer_epoll(const thread_specifier& scope) : timer(scope) {
                                 "Unable to create/add timer fd for non-recurring timer");
     }
     m_common_timer_io_dev->tinfo = std::make_unique< timer_info >(this);
+    if (IM_DYNAMIC_CONFIG(timer.wheel_enabled)) {
+        m_wheel = std::make_unique< timer_wheel >(IM_DYNAMIC_CONFIG(timer.wheel_tick_us) * 1000ul);
+    }
 }
 
 timer_epoll::~timer_epoll() {
@@ -54,6 +58,8 @@ void timer_epoll::stop() {
         // auto& tinfo = m_timer_list.top(); // TODO: Check if we need to make upcall that timer is cancelled
         m_timer_list.pop();
     }
+    if (m_wheel) { m_wheel->clear(); }
+
     // Now close the common timer
     if (m_common_timer_io_dev && (m_common_timer_io_dev->fd() != -1)) {
         iomanager.generic_interface()->remove_io_device(m_common_timer_io_dev, wait_type_t::spin);
@@ -68,7 +74,22 @@ void timer_epoll::stop() {
 }
 
 timer_handle_t timer_epoll::schedule(uint64_t nanos_after, bool recurring, void* cookie, timer_callback_t&& timer_fn,
-                                     bool wait_to_schedule) {
+                                     bool wait_to_schedule, uint64_t slack_nanos) {
+    if (m_wheel) {
+        // Both recurring and non-recurring timers are multiplexed on the common timer fd, which needs to be re-armed
+        // only if it is currently armed beyond the window this timer can tolerate
+        const auto expiry{std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanos_after)};
+        LOCK_IF_GLOBAL();
+        const auto whdl{
+            m_wheel->schedule(expiry, cookie, std::move(timer_fn), recurring ? nanos_after : 0, slack_nanos)};
+        const auto fire_at{*m_wheel->expiry_time(whdl)};
+        if (std::max(fire_at, expiry + std::chrono::nanoseconds(slack_nanos)) < m_armed_expiry) {
+            arm_common_timer(fire_at);
+        }
+        UNLOCK_IF_GLOBAL();
+        return timer_handle_t(this, whdl);
+    }
+
     struct itimerspec tspec;
     timer_handle_t thdl;
     IODevice* raw_iodev = nullptr;
@@ -132,6 +153,16 @@ void timer_epoll::cancel(timer_handle_t thandle, bool wait_to_cancel) {
                        PROTECTED_REGION(m_recurring_timer_iodevs.erase(iodev));
                    },
                    [&](timer_heap_t::handle_type heap_hdl) { PROTECTED_REGION(m_timer_list.erase(heap_hdl)); },
+                   [&](timer_wheel::handle_t whdl) {
+                       PROTECTED_REGION(m_wheel->cancel(whdl));
+                       if (wait_to_cancel && !is_thread_local()) {
+                           // Callbacks are called outside the lock, wait for the ones already picked up by any
+                           // thread to be done
+                           iomanager.run_on(
+                               std::get< thread_regex >(m_scope), []([[maybe_unused]] io_thread_addr_t taddr) {},
+                               wait_type_t::spin);
+                       }
+                   },
                    [&](spdk_timer_ptr stinfo) { assert(0); },
                },
                thandle.second);
@@ -149,7 +180,27 @@ void timer_epoll::on_timer_fd_notification(IODevice* iodev) {
 }
 
 void timer_epoll::on_timer_armed(IODevice* iodev) {
-    if (iodev == m_common_timer_io_dev.get()) {
+    if ((iodev == m_common_timer_io_dev.get()) && m_wheel) {
+        // Like the heap below, expired timers are popped and called one at a time outside the lock, so that a timer
+        // cancelled by the callback of an earlier one is not called. Callback is called in place, wheel keeps it till
+        // the call is done even if the timer gets cancelled. Common timer is re-armed after all of them.
+        timer_wheel::expired_timer_t e;
+        LOCK_IF_GLOBAL();
+        m_wheel->expire(std::chrono::steady_clock::now());
+        while (m_wheel->pop_expired(e)) {
+            UNLOCK_IF_GLOBAL();
+            (*e.cb)(e.cookie);
+            LOCK_IF_GLOBAL();
+            m_wheel->done_expired(e);
+        }
+        const auto next{m_wheel->next_expiry()};
+        if (next) {
+            arm_common_timer(*next);
+        } else {
+            m_armed_expiry = std::chrono::steady_clock::time_point::max();
+        }
+        UNLOCK_IF_GLOBAL();
+    } else if (iodev == m_common_timer_io_dev.get()) {
         // This is a non-recurring timer, loop in all timers in heap and call which are expired
         LOCK_IF_GLOBAL();
         while (!m_timer_list.empty()) {
@@ -170,6 +221,19 @@ void timer_epoll::on_timer_armed(IODevice* iodev) {
     }
 }
 
+void timer_epoll::arm_common_timer(std::chrono::steady_clock::time_point expiry) {
+    // steady_clock is CLOCK_MONOTONIC, so the expiry can be set as absolute time. Expiry in the past fires right away
+    const auto nanos{std::chrono::duration_cast< std::chrono::nanoseconds >(expiry.time_since_epoch()).count()};
+    struct itimerspec tspec {};
+    tspec.it_value.tv_sec = nanos / 1000000000;
+    tspec.it_value.tv_nsec = nanos % 1000000000;
+    if (timerfd_settime(m_common_timer_io_dev->fd(), TFD_TIMER_ABSTIME, &tspec, NULL) == -1) {
+        LOGDFATAL("Unable to set a timer using timer fd = {}, errno={}", m_common_timer_io_dev->fd(), errno);
+        throw std::system_error(errno, std::generic_category(), "timer fd set time failed");
+    }
+    m_armed_expiry = expiry;
+}
+
 std::shared_ptr< IODevice > timer_epoll::setup_timer_fd(bool is_recurring, bool wait_to_setup) {
     // Create a timer fd
     auto fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
@@ -192,7 +256,7 @@ timer_spdk::timer_spdk(const thread_specifier& scope) : timer(scope) {}
 timer_spdk::~timer_spdk() = default;
 
 timer_handle_t timer_spdk::schedule(uint64_t nanos_after, bool recurring, void* cookie, timer_callback_t&& timer_fn,
-                                    bool wait_to_schedule) {
+                                    bool wait_to_schedule, uint64_t slack_nanos) {
     timer_handle_t thdl;
 
     // Multi-thread timer only for global recurring timers, rest are single threaded timers
@@ -239,6 +303,7 @@ void timer_spdk::cancel(timer_handle_t thdl, bool wait_to_cancel) {
                               }
                           },
                           [&](timer_heap_t::handle_type heap_hdl) { assert(0); },
+                          [&](timer_wheel::handle_t whdl) { assert(0); },
                           [&](std::shared_ptr< IODevice > iodev) { assert(0); }},
                thdl.second);
 }
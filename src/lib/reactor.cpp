@@ -90,6 +90,9 @@ void IOReactor::init() {
 #endif
 
     m_metrics = std::make_unique< IOThreadMetrics >(m_reactor_name);
+    if (is_worker()) {
+        m_task_q = std::make_unique< chase_lev_deque< stealable_task > >(IM_DYNAMIC_CONFIG(task_q.capacity));
+    }
 
     // Create a new IO lightweight thread (if need be) and add it to its list, notify everyone about the new thread
     start_io_thread(iomanager.make_io_thread(this));
@@ -100,6 +103,7 @@ void IOReactor::init() {
 
 bool IOReactor::listen_once() {
     listen();
+    if (m_task_q && m_keep_running) { run_tasks(); }
     if (m_keep_running) {
         auto& sentinel_cb = iomanager.generic_interface()->get_listen_sentinel_cb();
         if (sentinel_cb) { sentinel_cb(); }
@@ -133,6 +137,13 @@ bool IOReactor::listen_once() {
 void IOReactor::stop() {
     m_keep_running = false;
 
+    // Fire and forget tasks which are not stolen yet are run before exiting
+    if (m_task_q) {
+        while (auto* task = m_task_q->pop()) {
+            run_task(task);
+        }
+    }
+
     for (auto thr : m_io_threads) {
         stop_io_thread(thr);
     }
@@ -211,8 +222,86 @@ int IOReactor::remove_iodev(const io_device_const_ptr& iodev, const io_thread_t&
 
 const io_thread_t& IOReactor::iothread_self() const { return m_io_threads[0]; };
 
+void IOReactor::enqueue_task(stealable_task* task) {
+    if (!m_task_q->push(task)) {
+        // Local queue is full, nothing better than running it right away
+        run_task(task);
+        return;
+    }
+
+    // Backlog is building up, wake up another worker to steal from us. Waking for every doubling of the backlog,
+    // keeps the wakeups few while the backlog is large.
+    const auto depth{m_task_q->size()};
+    if ((depth >= 2) && ((depth & (depth - 1)) == 0)) { iomanager.wake_task_thief(this); }
+}
+
+void IOReactor::run_tasks() {
+    const auto max_tasks{IM_DYNAMIC_CONFIG(task_q.max_tasks_before_yield)};
+    uint32_t stolen{0};
+    for (uint32_t ran{0}; ran < max_tasks; ++ran) {
+        auto* task = m_task_q->pop();
+        if (task == nullptr) {
+            // Steal only if this loop has nothing else to do
+            if (m_load.queued_work() != 0) { break; }
+            task = iomanager.steal_task(this);
+            if (task == nullptr) { break; }
+            ++m_metrics->tasks_stolen_count;
+            ++stolen;
+        }
+        run_task(task);
+    }
+
+    // Victim wakes up a thief only when its backlog doubles, so keep coming back to steal without blocking in between,
+    // till there is nothing left to steal
+    m_keep_stealing = (stolen != 0);
+}
+
+void IOReactor::run_task(stealable_task* task) {
+    ++m_metrics->tasks_run_count;
+    task->method(iothread_self()->thread_addr);
+    stealable_task::free(task);
+}
+
+void IOReactor::drive_io_submitted(uint32_t count) {
+    m_drive_ios += count;
+    m_metrics->drive_ios_inflight = m_drive_ios;
+    m_load.drive_ios.store(m_drive_ios, std::memory_order_relaxed);
+}
+
+void IOReactor::drive_io_completed(uint32_t count) {
+    m_drive_ios -= count;
+    m_metrics->drive_ios_inflight = m_drive_ios;
+    m_load.drive_ios.store(m_drive_ios, std::memory_order_relaxed);
+}
+
+void IOReactor::msgs_dequeued(uint32_t count) {
+    if (count == 0) { return; }
+    m_load.msgs_dequeued.store(m_load.msgs_dequeued.load(std::memory_order_relaxed) + count,
+                               std::memory_order_relaxed);
+    m_metrics->msg_qdepth = m_load.msg_qdepth();
+}
+
+void IOReactor::account_wait(const std::chrono::steady_clock::time_point& wait_start,
+                             const std::chrono::steady_clock::time_point& wait_end) {
+    // Time since the previous wait returned is spent busy, time in this wait is spent idle
+    const auto busy_ns{std::chrono::duration_cast< std::chrono::nanoseconds >(wait_start - m_last_wait_end).count()};
+    const auto idle_ns{std::chrono::duration_cast< std::chrono::nanoseconds >(wait_end - wait_start).count()};
+    m_last_wait_end = wait_end;
+    if ((busy_ns + idle_ns) <= 0) { return; }
+
+    // Moving average in 1/256th of a percent, latest sample gets 1/8th of the weight
+    const int64_t cur_pct_x256{(busy_ns * 100 * 256) / (busy_ns + idle_ns)};
+    m_busy_pct_ewma = static_cast< uint32_t >(static_cast< int64_t >(m_busy_pct_ewma) +
+                                              ((cur_pct_x256 - static_cast< int64_t >(m_busy_pct_ewma)) / 8));
+
+    const uint32_t busy_pct{m_busy_pct_ewma / 256};
+    m_metrics->busy_pct = busy_pct;
+    m_load.busy_pct.store(busy_pct, std::memory_order_relaxed);
+}
+
 bool IOReactor::deliver_msg(io_thread_addr_t taddr, iomgr_msg* msg, IOReactor* sender_reactor) {
-    msg->m_dest_thread = taddr;
+    // Broadcast msg is shared across destinations, its address is set once by the sender
+    if (!msg->m_is_broadcast) { msg->m_dest_thread = taddr; }
     msg->set_pending();
 
     // If the sender and receiver are same thread, take a shortcut to directly handle the message. Of course, this
@@ -271,6 +360,16 @@ void IOReactor::handle_msg(iomgr_msg* msg) {
             break;
         }
 
+        case iomgr_msg_type::MSG_BATCH: {
+            // Each message in the batch is handled (and completed) on its own, in the order it was batched
+            auto& batch = std::get< msg_batch_t >(msg->m_data);
+            for (auto& bmsg : batch) {
+                handle_msg(bmsg);
+            }
+            batch.clear();
+            break;
+        }
+
 #if 0
         case iomgr_msg_type::ADD_DEVICE: {
             add_iodev(msg->iodevice_data());
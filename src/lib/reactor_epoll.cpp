@@ -112,9 +112,22 @@ void IOReactorEPoll::listen() {
     std::array< struct epoll_event, MAX_EVENTS > events;
 
     int num_fds{0};
+    const auto wait_start{Clock::now()};
     do {
-        num_fds = epoll_wait(m_epollfd, &events[0], MAX_EVENTS, get_poll_interval());
+        // Let the senders know that we are going to park in epoll_wait, so that they ring the doorbell. Recheck
+        // the msg q after publishing it, to close the race with a sender which enqueued before it saw the flag.
+        // A sender which rang the doorbell has cleared the flag already. Polled drive ios need us to keep polling.
+        auto timeout{has_polled_ios() ? 0 : get_poll_interval()};
+        const bool parked{timeout != 0};
+        if (parked) {
+            m_parked_in_wait.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!m_msg_q.empty() || has_pending_tasks()) { timeout = 0; }
+        }
+        num_fds = epoll_wait(m_epollfd, &events[0], MAX_EVENTS, timeout);
+        if (parked && !m_parked_in_wait.exchange(false, std::memory_order_relaxed)) { ++m_metrics->msg_doorbell_count; }
     } while (num_fds < 0 && errno == EINTR);
+    account_wait(wait_start, Clock::now());
 
     if (num_fds == 0) {
         idle_time_wakeup_poller();
@@ -149,6 +162,9 @@ void IOReactorEPoll::listen() {
             }
         }
     }
+
+    // Messages which were put while we were not parked have no doorbell, pick them up now
+    if (is_io_reactor() && !m_msg_q.empty()) { m_metrics->msg_doorbell_avoided_count += process_messages(); }
 }
 
 int IOReactorEPoll::add_iodev_internal(const io_device_const_ptr& iodev, [[maybe_unused]] const io_thread_t& thr) {
@@ -182,10 +198,13 @@ bool IOReactorEPoll::put_msg(iomgr_msg* msg) {
     REACTOR_LOG(DEBUG, iomgr, msg->m_dest_thread, "Put msg of type {} to its msg fd = {}, ptr = {}", msg->m_type,
                 m_reactor_num, msg->m_dest_thread, m_msg_iodev->fd(), (void*)m_msg_iodev.get());
 
+    msg_enqueued();
     m_msg_q.enqueue(msg);
 
-    // Raise an event only in case msg handler is not currently running
-    if (!m_msg_handler_on.load(std::memory_order_acquire)) {
+    // Ring the doorbell only if the reactor is parked in epoll_wait. Otherwise it is guaranteed to look at the
+    // msg q before it parks again. Only one of the concurrent senders rings it, the rest coalesce into it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_parked_in_wait.load(std::memory_order_relaxed) && m_parked_in_wait.exchange(false)) {
         const uint64_t temp{1};
         while ((write(m_msg_iodev->fd(), &temp, sizeof(uint64_t)) < 0) && (errno == EAGAIN)) {
             ++m_metrics->msg_iodev_busy_count;
@@ -201,39 +220,29 @@ void IOReactorEPoll::on_msg_fd_notification() {
         ++m_metrics->msg_iodev_busy_count;
     }
 
-    process_messages();
+    // One doorbell could cover all the messages of this batch
+    const auto msg_count{process_messages()};
+    if (msg_count > 1) { m_metrics->msg_doorbell_avoided_count += (msg_count - 1); }
 }
 
-void IOReactorEPoll::process_messages() {
+uint32_t IOReactorEPoll::process_messages() {
     const auto max_msg_batch_size{IM_DYNAMIC_CONFIG(max_msgs_before_yield)};
     uint32_t msg_count{0};
-    bool in_retry{false};
-
-    m_msg_handler_on.store(true, std::memory_order_release);
-    while (true) {
-        // Start pulling all the messages and handle them.
-        while (msg_count < max_msg_batch_size) {
-            iomgr_msg* msg;
-            if (!m_msg_q.try_dequeue(msg)) { break; }
-            handle_msg(msg);
-            ++msg_count;
-        }
 
-        if ((msg_count == max_msg_batch_size) && (!m_msg_q.empty())) {
-            REACTOR_LOG(DEBUG, iomgr, , "Reached max msg_count batch {}, yielding and will process again", msg_count);
-            const uint64_t temp{1};
-            while ((write(m_msg_iodev->fd(), &temp, sizeof(uint64_t)) < 0) && (errno == EAGAIN)) {
-                ++m_metrics->msg_iodev_busy_count;
-            }
-            m_msg_handler_on.store(false, std::memory_order_release);
-            break;
-        } else if (in_retry) { // Already retrying after msg handler on unset
-            break;
-        } else {
-            m_msg_handler_on.store(false, std::memory_order_release);
-            in_retry = true;
-        }
+    // Start pulling all the messages and handle them. If we reach the max batch, we yield to other completions.
+    // There is no need to ring our own doorbell to come back, since listen doesn't park while the msg q is non-empty
+    while (msg_count < max_msg_batch_size) {
+        iomgr_msg* msg;
+        if (!m_msg_q.try_dequeue(msg)) { break; }
+        handle_msg(msg);
+        ++msg_count;
+    }
+
+    if ((msg_count == max_msg_batch_size) && (!m_msg_q.empty())) {
+        REACTOR_LOG(DEBUG, iomgr, , "Reached max msg_count batch {}, yielding and will process again", msg_count);
     }
+    msgs_dequeued(msg_count);
+    return msg_count;
 }
 
 void IOReactorEPoll::on_user_iodev_notification(IODevice* iodev, int event) {
@@ -255,7 +264,7 @@ void IOReactorEPoll::idle_time_wakeup_poller() {
 
     // Idle time wakeup poller process messages and make any registered callers which look for any
     // other completions.
-    process_messages();
+    m_metrics->msg_doorbell_avoided_count += process_messages();
     for (auto& cb : m_poll_interval_cbs) {
         if (cb) { cb(); }
     }
@@ -0,0 +1,74 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#include <random>
+#include "include/reactor_selector.hpp"
+
+namespace iomgr {
+// Number of random probes before falling back to a scan for an usable reactor
+static constexpr uint32_t max_random_probes{4};
+
+static bool is_usable(const IOReactor* reactor) { return (reactor != nullptr) && reactor->is_io_reactor(); }
+
+IOReactor* ReactorSelector::select(const std::vector< std::shared_ptr< IOReactor > >& reactors) {
+    const auto nreactors{reactors.size()};
+    if (nreactors == 0) { return nullptr; }
+
+    switch (policy()) {
+    case reactor_select_policy_t::round_robin:
+        for (size_t i{0}; i < nreactors; ++i) {
+            auto* reactor{reactors[m_rr_idx.fetch_add(1, std::memory_order_relaxed) % nreactors].get()};
+            if (is_usable(reactor)) { return reactor; }
+        }
+        return nullptr;
+
+    case reactor_select_policy_t::random:
+        return pick_random(reactors);
+
+    case reactor_select_policy_t::power_of_two:
+    case reactor_select_policy_t::queue_depth:
+    default: {
+        auto* r1{pick_random(reactors)};
+        auto* r2{pick_random(reactors)};
+        if ((r1 == nullptr) || (r2 == nullptr)) { return r1 ? r1 : r2; }
+        return (load_score(r2) < load_score(r1)) ? r2 : r1;
+    }
+    }
+}
+
+IOReactor* ReactorSelector::pick_random(const std::vector< std::shared_ptr< IOReactor > >& reactors) const {
+    static thread_local std::random_device s_rd{};
+    static thread_local std::default_random_engine s_re{s_rd()};
+
+    const auto nreactors{reactors.size()};
+    std::uniform_int_distribution< size_t > dist{0, nreactors - 1};
+    size_t idx{0};
+    for (uint32_t probe{0}; probe < max_random_probes; ++probe) {
+        idx = dist(s_re);
+        if (is_usable(reactors[idx].get())) { return reactors[idx].get(); }
+    }
+
+    // Very sparse list (reactors starting or stopping), scan from the last probe
+    for (size_t i{1}; i < nreactors; ++i) {
+        auto* reactor{reactors[(idx + i) % nreactors].get()};
+        if (is_usable(reactor)) { return reactor; }
+    }
+    return nullptr;
+}
+
+int64_t ReactorSelector::load_score(const IOReactor* reactor) const {
+    const auto& load{reactor->load()};
+    return (policy() == reactor_select_policy_t::queue_depth) ? load.queued_work() : load.score();
+}
+} // namespace iomgr
@@ -0,0 +1,321 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+extern "C" {
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <time.h>
+}
+
+#include <sisl/logging/logging.h>
+#include "include/iomgr.hpp"
+#include "include/reactor_uring.hpp"
+#include "include/iomgr_config.hpp"
+#include <sisl/fds/obj_allocator.hpp>
+
+namespace iomgr {
+
+#define MAX_URING_EVENTS 64
+
+IOReactorUring::IOReactorUring() : m_msg_q() {}
+
+bool IOReactorUring::reactor_specific_init_thread(const io_thread_t& thr) {
+    const auto qdepth{IM_DYNAMIC_CONFIG(uring->reactor_queue_depth)};
+    int ret = io_uring_queue_init(qdepth, &m_ring, 0);
+    if (ret < 0) {
+        REACTOR_LOG(ERROR, base, thr->thread_addr, "io_uring_queue_init failed: {}", strerror(-ret));
+        return false;
+    }
+    m_ring_inited = true;
+    thr->thread_impl = m_reactor_num;
+
+    // Create a message fd and poll on it through the ring
+    m_msg_evfd = eventfd(0, EFD_NONBLOCK);
+    if (m_msg_evfd == -1) {
+        REACTOR_LOG(ERROR, base, thr->thread_addr, "Unable to open the eventfd, marking this as non-io reactor");
+        io_uring_queue_exit(&m_ring);
+        m_ring_inited = false;
+        return false;
+    }
+    arm_msg_poll();
+    io_uring_submit(&m_ring);
+    REACTOR_LOG(TRACE, iomgr, thr->thread_addr, "Uring created with qdepth={}, msg eventfd={}", qdepth, m_msg_evfd);
+
+    // Create a per thread timer
+    m_thread_timer = std::make_unique< timer_epoll >(iothread_self());
+    return true;
+}
+
+void IOReactorUring::reactor_specific_exit_thread(const io_thread_t& thr) {
+    // Stop the timer first, since it needs the ring to remove its iodevs
+    m_thread_timer->stop();
+
+    if (m_msg_evfd != -1) {
+        close(m_msg_evfd);
+        m_msg_evfd = -1;
+    }
+
+    if (m_ring_inited) {
+        io_uring_queue_exit(&m_ring);
+        m_ring_inited = false;
+    }
+    m_armed_iodevs.clear();
+
+    // Drain the message q and drop the message.
+    iomgr_msg* msg;
+    while (m_msg_q.try_dequeue(msg)) {
+        iomgr_msg::completed(msg);
+    }
+}
+
+void IOReactorUring::listen() {
+    if (io_uring_sq_ready(&m_ring) != 0) { io_uring_submit(&m_ring); }
+
+    struct io_uring_cqe* cqe{nullptr};
+    int ret{0};
+    // Let the senders know that we are going to park in the ring wait, so that they ring the doorbell. Recheck the
+    // msg q after publishing it, to close the race with a sender which enqueued before it saw the flag. Don't wait
+    // for events while there are tasks left behind in the local queue (or polled drive ios in flight) either. A sender
+    // which rang the doorbell has cleared the flag already.
+    auto poll_interval{has_polled_ios() ? 0 : get_poll_interval()};
+    const bool parked{poll_interval != 0};
+    if (parked) {
+        m_parked_in_wait.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_msg_q.empty() || has_pending_tasks()) { poll_interval = 0; }
+    }
+    const auto wait_start{std::chrono::steady_clock::now()};
+    if (poll_interval == 0) {
+        ret = io_uring_peek_cqe(&m_ring, &cqe);
+    } else if (poll_interval < 0) {
+        ret = io_uring_wait_cqe(&m_ring, &cqe);
+    } else {
+        struct __kernel_timespec ts;
+        ts.tv_sec = poll_interval / 1000;
+        ts.tv_nsec = (poll_interval % 1000) * 1000 * 1000;
+        ret = io_uring_wait_cqe_timeout(&m_ring, &cqe, &ts);
+    }
+    if (parked && !m_parked_in_wait.exchange(false, std::memory_order_relaxed)) { ++m_metrics->msg_doorbell_count; }
+    account_wait(wait_start, std::chrono::steady_clock::now());
+
+    if (ret == -EINTR) {
+        return;
+    } else if ((ret == -ETIME) || (ret == -EAGAIN)) {
+        idle_time_wakeup_poller();
+        return;
+    } else if (ret < 0) {
+        REACTOR_LOG(ERROR, base, , "uring wait failed: {}", strerror(-ret));
+        return;
+    }
+
+    // Collect the batch of completions and release the CQ slots before handling them, so that callbacks which
+    // submit new ios on this ring have all the CQ space available.
+    std::array< struct io_uring_cqe*, MAX_URING_EVENTS > cqes;
+    std::array< std::pair< uint64_t, int32_t >, MAX_URING_EVENTS > events;
+    const auto num_cqes{io_uring_peek_batch_cqe(&m_ring, cqes.data(), MAX_URING_EVENTS)};
+    for (uint32_t i{0}; i < num_cqes; ++i) {
+        events[i] = std::make_pair(static_cast< uint64_t >(cqes[i]->user_data), cqes[i]->res);
+    }
+    io_uring_cq_advance(&m_ring, num_cqes);
+    m_metrics->fds_on_event_count += num_cqes;
+
+    for (uint32_t i{0}; i < num_cqes; ++i) {
+        handle_cqe(events[i].first, events[i].second);
+
+        // It is possible for io thread status by the msg processor. Catch at the exit and return
+        if (!is_io_reactor()) {
+            REACTOR_LOG(INFO, base, , "listen will exit because this is no longer an io reactor");
+            return;
+        }
+    }
+
+    // Messages which were put while we were not parked have no doorbell, pick them up now
+    if (is_io_reactor() && !m_msg_q.empty()) { m_metrics->msg_doorbell_avoided_count += process_messages(); }
+}
+
+void IOReactorUring::handle_cqe(uint64_t user_data, int32_t res) {
+    if (user_data == LIBURING_UDATA_TIMEOUT) { return; } // Internal timeout sqe of io_uring_wait_cqe_timeout
+
+    switch (user_data & cqe_tag_mask) {
+    case cqe_tag_msg_poll:
+        REACTOR_LOG(TRACE, iomgr, , "Processing event on msg fd: {}", m_msg_evfd);
+        ++m_metrics->msg_event_wakeup_count;
+        on_msg_fd_notification();
+        if (is_io_reactor()) { arm_msg_poll(); }
+        break;
+
+    case cqe_tag_iodev_poll: {
+        IODevice* iodev = reinterpret_cast< IODevice* >(user_data & ~cqe_tag_mask);
+
+        // Poll could be completed as part of poll remove or the iodev could be removed after poll completed
+        if ((res == -ECANCELED) || (m_armed_iodevs.find(iodev) == m_armed_iodevs.end())) { break; }
+        if (res < 0) {
+            REACTOR_LOG(ERROR, base, , "Poll on iodev {} failed with error: {}", iodev->dev_id(), strerror(-res));
+        } else if (iodev->tinfo) {
+            ++m_metrics->timer_wakeup_count;
+            timer_epoll::on_timer_fd_notification(iodev);
+        } else {
+            on_user_iodev_notification(iodev, res);
+        }
+
+        // Poll is one shot, rearm it if callback has not removed the device
+        if (m_armed_iodevs.find(iodev) != m_armed_iodevs.end()) { arm_iodev_poll(iodev); }
+        break;
+    }
+
+    case cqe_tag_ignore:
+        break;
+
+    case cqe_tag_drive_io:
+    default:
+        if (m_drive_cqe_handler) {
+            m_drive_cqe_handler(reinterpret_cast< void* >(user_data), res);
+        } else {
+            LOGDFATAL("Received uring completion with user_data={} but no drive completion handler attached",
+                      user_data);
+        }
+        break;
+    }
+}
+
+struct io_uring_sqe* IOReactorUring::get_sqe() {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+    if (sqe == nullptr) {
+        // SQ is full, submit what we have and retry
+        io_uring_submit(&m_ring);
+        sqe = io_uring_get_sqe(&m_ring);
+    }
+    RELEASE_ASSERT_NOTNULL((void*)sqe, "Unable to get sqe from reactor uring even after submission");
+    return sqe;
+}
+
+void IOReactorUring::arm_iodev_poll(IODevice* iodev) {
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_poll_add(sqe, iodev->fd(), iodev->ev);
+    io_uring_sqe_set_data(sqe, reinterpret_cast< void* >(reinterpret_cast< uint64_t >(iodev) | cqe_tag_iodev_poll));
+}
+
+void IOReactorUring::arm_msg_poll() {
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_poll_add(sqe, m_msg_evfd, POLLIN);
+    io_uring_sqe_set_data(sqe, reinterpret_cast< void* >(cqe_tag_msg_poll));
+}
+
+int IOReactorUring::add_iodev_internal(const io_device_const_ptr& iodev, [[maybe_unused]] const io_thread_t& thr) {
+    IODevice* dev = const_cast< IODevice* >(iodev.get());
+    DEBUG_ASSERT_EQ((reinterpret_cast< uint64_t >(dev) & cqe_tag_mask), 0, "IODevice pointer not aligned for tagging");
+    if (!m_armed_iodevs.insert(dev).second) {
+        LOGDFATAL("Adding fd {} to this thread's uring failed, it is already added", iodev->fd());
+        return -1;
+    }
+    arm_iodev_poll(dev);
+    io_uring_submit(&m_ring);
+    REACTOR_LOG(DEBUG, iomgr, thr->thread_addr, "Added fd {} to this io thread's uring, iodev={}", iodev->fd(),
+                (void*)dev);
+    return 0;
+}
+
+int IOReactorUring::remove_iodev_internal(const io_device_const_ptr& iodev, [[maybe_unused]] const io_thread_t& thr) {
+    IODevice* dev = const_cast< IODevice* >(iodev.get());
+    if (m_armed_iodevs.erase(dev) == 0) {
+        LOGDFATAL("Removing fd {} from this thread's uring failed, it was never added", iodev->fd());
+        return -1;
+    }
+
+    // Remove the pending poll. If the poll is completed already, the completion is ignored since it is no longer
+    // part of armed iodevs.
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_rw(IORING_OP_POLL_REMOVE, sqe, -1, nullptr, 0, 0);
+    sqe->addr = reinterpret_cast< uint64_t >(dev) | cqe_tag_iodev_poll;
+    io_uring_sqe_set_data(sqe, reinterpret_cast< void* >(cqe_tag_ignore));
+    io_uring_submit(&m_ring);
+    REACTOR_LOG(DEBUG, iomgr, thr->thread_addr, "Removed fd {} from this io thread's uring", iodev->fd());
+    return 0;
+}
+
+bool IOReactorUring::put_msg(iomgr_msg* msg) {
+    if (m_msg_evfd == -1) return false;
+
+    REACTOR_LOG(DEBUG, iomgr, msg->m_dest_thread, "Put msg of type {} to its msg fd = {}", msg->m_type, m_msg_evfd);
+    msg_enqueued();
+    m_msg_q.enqueue(msg);
+
+    // Ring the doorbell only if the reactor is parked in the ring wait. Otherwise it is guaranteed to look at the
+    // msg q before it parks again. Only one of the concurrent senders rings it, the rest coalesce into it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_parked_in_wait.load(std::memory_order_relaxed) && m_parked_in_wait.exchange(false)) {
+        const uint64_t temp{1};
+        while ((write(m_msg_evfd, &temp, sizeof(uint64_t)) < 0) && (errno == EAGAIN)) {
+            ++m_metrics->msg_iodev_busy_count;
+        }
+    }
+    return true;
+}
+
+void IOReactorUring::on_msg_fd_notification() {
+    uint64_t temp;
+    while ((read(m_msg_evfd, &temp, sizeof(uint64_t)) < 0) && errno == EAGAIN) {
+        ++m_metrics->msg_iodev_busy_count;
+    }
+
+    // One doorbell could cover all the messages of this batch
+    const auto msg_count{process_messages()};
+    if (msg_count > 1) { m_metrics->msg_doorbell_avoided_count += (msg_count - 1); }
+}
+
+uint32_t IOReactorUring::process_messages() {
+    const auto max_msg_batch_size{IM_DYNAMIC_CONFIG(max_msgs_before_yield)};
+    uint32_t msg_count{0};
+
+    // Start pulling all the messages and handle them. If we reach the max batch, we yield to other completions.
+    // There is no need to ring our own doorbell to come back, since listen doesn't park while the msg q is non-empty
+    while (msg_count < max_msg_batch_size) {
+        iomgr_msg* msg;
+        if (!m_msg_q.try_dequeue(msg)) { break; }
+        handle_msg(msg);
+        ++msg_count;
+    }
+
+    if ((msg_count == max_msg_batch_size) && (!m_msg_q.empty())) {
+        REACTOR_LOG(DEBUG, iomgr, , "Reached max msg_count batch {}, yielding and will process again", msg_count);
+    }
+    msgs_dequeued(msg_count);
+    return msg_count;
+}
+
+void IOReactorUring::on_user_iodev_notification(IODevice* iodev, int event) {
+    ++m_metrics->outstanding_ops;
+    ++m_metrics->io_event_wakeup_count;
+
+    REACTOR_LOG(TRACE, iomgr, , "Processing event on user iodev: {}", iodev->dev_id());
+    iodev->cb(iodev, iodev->cookie, event);
+
+    --m_metrics->outstanding_ops;
+}
+
+bool IOReactorUring::is_iodev_addable(const io_device_const_ptr& iodev, const io_thread_t& thread) const {
+    return (!iodev->is_spdk_dev() && IOReactor::is_iodev_addable(iodev, thread));
+}
+
+void IOReactorUring::idle_time_wakeup_poller() {
+    ++m_metrics->idle_wakeup_count;
+
+    m_metrics->msg_doorbell_avoided_count += process_messages();
+    for (auto& cb : m_poll_interval_cbs) {
+        if (cb) { cb(); }
+    }
+}
+} // namespace iomgr
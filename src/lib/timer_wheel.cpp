@@ -0,0 +1,291 @@
+/************************************************************************
+ * Modifications Copyright 2017-2019 eBay Inc.
+ * Author/Developer(s): Harihara Kadayam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ * specific language governing permissions and limitations under the License.
+ **************************************************************************/
+#include <algorithm>
+#include "timer_wheel.hpp"
+
+namespace iomgr {
+static inline uint64_t rotate_right(uint64_t x, uint32_t s) { return (x >> s) | (x << ((64 - s) & 63)); }
+
+timer_wheel::timer_wheel(uint64_t tick_ns, Clock::time_point base) : m_tick_ns{std::max(tick_ns, 1ul)}, m_base{base} {
+    m_slot_head.fill(invalid_idx);
+}
+
+timer_wheel::handle_t timer_wheel::schedule(Clock::time_point expiry, void* cookie, timer_callback_t&& fn,
+                                            uint64_t interval_ns, uint64_t slack_ns) {
+    const auto idx{alloc_node()};
+    auto& n{m_nodes[idx]};
+    n.cb = std::move(fn);
+    n.cookie = cookie;
+    n.interval_ticks = interval_ns ? std::max((interval_ns + m_tick_ns - 1) / m_tick_ns, 1ul) : 0;
+
+    const auto slack_ticks{slack_ns / m_tick_ns};
+    n.align_ticks = slack_ticks ? (1ul << (63 - __builtin_clzll(slack_ticks))) : 1;
+    n.due_tick = tick_ceil(expiry);
+    n.expiry_tick = align_up(n.due_tick, n.align_ticks);
+    place(idx);
+    ++m_count;
+    return handle_t{idx, n.gen};
+}
+
+bool timer_wheel::cancel(const handle_t& hdl) {
+    if (hdl.idx >= m_nodes.size()) { return false; }
+    auto& n{m_nodes[hdl.idx]};
+    if ((n.gen != hdl.gen) || (n.slot == invalid_idx)) { return false; }
+
+    unlink(hdl.idx);
+    release_node(hdl.idx);
+    --m_count;
+    return true;
+}
+
+size_t timer_wheel::expire(Clock::time_point now) {
+    size_t expired{0};
+    const auto to_tick{tick_floor(now)};
+
+    while (m_cur_tick <= to_tick) {
+        if (m_count == 0) {
+            m_cur_tick = to_tick + 1;
+            break;
+        }
+
+        if ((m_cur_tick & (slots_per_level - 1)) == 0) {
+            // Crossed a level 0 rotation, bring down the due slots of upper levels, upper level only on its rotation
+            for (uint32_t l{1}; l < num_levels; ++l) {
+                cascade(l);
+                if (((m_cur_tick >> (slot_bits * l)) & (slots_per_level - 1)) != 0) { break; }
+            }
+        }
+        expired += expire_slot(m_cur_tick & (slots_per_level - 1));
+        ++m_cur_tick;
+
+        // Skip the empty level 0 slots upto the next rotation, where cascade could bring in more
+        const auto idx{static_cast< uint32_t >(m_cur_tick & (slots_per_level - 1))};
+        if (idx != 0) {
+            const auto pending{m_occupied[0] >> idx};
+            const auto next_tick{pending ? (m_cur_tick + __builtin_ctzll(pending))
+                                         : ((m_cur_tick | (slots_per_level - 1)) + 1)};
+            m_cur_tick = std::min(next_tick, to_tick + 1);
+        }
+    }
+    return expired;
+}
+
+bool timer_wheel::pop_expired(expired_timer_t& out) {
+    const auto idx{m_expired_head};
+    if (idx == invalid_idx) { return false; }
+
+    unlink(idx);
+    auto& n{m_nodes[idx]};
+    ++n.in_call;
+    out = expired_timer_t{&n.cb, n.cookie, idx};
+    if (n.interval_ticks) {
+        // Next interval, but if we are running behind, skip to the first one which is not yet due
+        n.due_tick += n.interval_ticks;
+        if (n.due_tick < m_cur_tick) { n.due_tick = m_cur_tick; }
+        n.expiry_tick = align_up(n.due_tick, n.align_ticks);
+        place(idx);
+    } else {
+        n.free_on_return = true;
+        --m_count;
+    }
+    return true;
+}
+
+void timer_wheel::done_expired(const expired_timer_t& e) {
+    auto& n{m_nodes[e.idx]};
+    if ((--n.in_call == 0) && n.free_on_return) { free_node(e.idx); }
+}
+
+std::optional< timer_wheel::Clock::time_point > timer_wheel::expiry_time(const handle_t& hdl) const {
+    if (hdl.idx >= m_nodes.size()) { return std::nullopt; }
+    const auto& n{m_nodes[hdl.idx]};
+    if ((n.gen != hdl.gen) || (n.slot == invalid_idx)) { return std::nullopt; }
+    return m_base + std::chrono::nanoseconds(std::max(n.expiry_tick, m_cur_tick) * m_tick_ns);
+}
+
+void timer_wheel::clear() {
+    for (uint32_t idx{0}; idx < m_nodes.size(); ++idx) {
+        if (m_nodes[idx].slot != invalid_idx) {
+            unlink(idx);
+            release_node(idx);
+        }
+    }
+    m_count = 0;
+}
+
+std::optional< timer_wheel::Clock::time_point > timer_wheel::next_expiry() const {
+    if (m_count == 0) { return std::nullopt; }
+    if (m_expired_head != invalid_idx) {
+        return m_base + std::chrono::nanoseconds(m_nodes[m_expired_head].expiry_tick * m_tick_ns);
+    }
+
+    uint64_t next_tick{UINT64_MAX};
+    for (uint32_t l{0}; l < num_levels; ++l) {
+        if (m_occupied[l] == 0) { continue; }
+
+        // Slot of the current position is due now only if we are exactly at its start (not yet cascaded/expired),
+        // otherwise it holds the timers of the next rotation
+        const auto shift{slot_bits * l};
+        const auto at_start{(m_cur_tick & ((1ul << shift) - 1)) == 0};
+        const auto base{(m_cur_tick >> shift) + (at_start ? 0 : 1)};
+        const auto k{__builtin_ctzll(rotate_right(m_occupied[l], base & (slots_per_level - 1)))};
+        next_tick = std::min(next_tick, (base + k) << shift);
+    }
+    return m_base + std::chrono::nanoseconds(next_tick * m_tick_ns);
+}
+
+uint32_t timer_wheel::alloc_node() {
+    if (m_free_head != invalid_idx) {
+        const auto idx{m_free_head};
+        m_free_head = m_nodes[idx].next;
+        return idx;
+    }
+    m_nodes.emplace_back();
+    return static_cast< uint32_t >(m_nodes.size() - 1);
+}
+
+void timer_wheel::free_node(uint32_t idx) {
+    auto& n{m_nodes[idx]};
+    n.cb = nullptr;
+    n.cookie = nullptr;
+    n.interval_ticks = 0;
+    n.free_on_return = false;
+    n.slot = invalid_idx;
+    n.prev = invalid_idx;
+    n.next = m_free_head;
+    ++n.gen;
+    m_free_head = idx;
+}
+
+void timer_wheel::release_node(uint32_t idx) {
+    auto& n{m_nodes[idx]};
+    if (n.in_call == 0) {
+        free_node(idx);
+    } else {
+        // Callback is being called, node is freed once the call is done. Handle is invalidated right away
+        ++n.gen;
+        n.free_on_return = true;
+    }
+}
+
+void timer_wheel::place(uint32_t idx) {
+    auto tick{std::max(m_nodes[idx].expiry_tick, m_cur_tick)};
+    const auto delta{tick - m_cur_tick};
+
+    uint32_t level{0};
+    while ((level < num_levels) && (delta >= (1ul << (slot_bits * (level + 1))))) {
+        ++level;
+    }
+    if (level == num_levels) {
+        // Beyond the wheel range, park at the farthest top level slot and re-place it upon cascade
+        level = num_levels - 1;
+        tick = m_cur_tick + (1ul << (slot_bits * num_levels)) - 1;
+    }
+    link(idx, (level * slots_per_level) + ((tick >> (slot_bits * level)) & (slots_per_level - 1)));
+}
+
+void timer_wheel::link(uint32_t idx, uint32_t slot) {
+    auto& n{m_nodes[idx]};
+    n.slot = slot;
+    n.prev = invalid_idx;
+    n.next = m_slot_head[slot];
+    if (n.next != invalid_idx) { m_nodes[n.next].prev = idx; }
+    m_slot_head[slot] = idx;
+    m_occupied[slot / slots_per_level] |= (1ul << (slot % slots_per_level));
+}
+
+void timer_wheel::link_expired(uint32_t idx) {
+    auto& n{m_nodes[idx]};
+    n.slot = expired_slot;
+    n.next = invalid_idx;
+    n.prev = m_expired_tail;
+    if (m_expired_tail != invalid_idx) {
+        m_nodes[m_expired_tail].next = idx;
+    } else {
+        m_expired_head = idx;
+    }
+    m_expired_tail = idx;
+}
+
+void timer_wheel::unlink(uint32_t idx) {
+    auto& n{m_nodes[idx]};
+    if (n.slot == expired_slot) {
+        if (n.prev != invalid_idx) {
+            m_nodes[n.prev].next = n.next;
+        } else {
+            m_expired_head = n.next;
+        }
+        if (n.next != invalid_idx) {
+            m_nodes[n.next].prev = n.prev;
+        } else {
+            m_expired_tail = n.prev;
+        }
+        n.slot = invalid_idx;
+        return;
+    }
+
+    if (n.prev != invalid_idx) {
+        m_nodes[n.prev].next = n.next;
+    } else {
+        m_slot_head[n.slot] = n.next;
+    }
+    if (n.next != invalid_idx) { m_nodes[n.next].prev = n.prev; }
+    if (m_slot_head[n.slot] == invalid_idx) {
+        m_occupied[n.slot / slots_per_level] &= ~(1ul << (n.slot % slots_per_level));
+    }
+    n.slot = invalid_idx;
+}
+
+void timer_wheel::cascade(uint32_t level) {
+    const uint32_t slot{(level * slots_per_level) +
+                        static_cast< uint32_t >((m_cur_tick >> (slot_bits * level)) & (slots_per_level - 1))};
+    auto idx{m_slot_head[slot]};
+    m_slot_head[slot] = invalid_idx;
+    m_occupied[level] &= ~(1ul << (slot % slots_per_level));
+
+    while (idx != invalid_idx) {
+        const auto next{m_nodes[idx].next};
+        place(idx);
+        idx = next;
+    }
+}
+
+size_t timer_wheel::expire_slot(uint32_t slot) {
+    size_t count{0};
+    auto idx{m_slot_head[slot]};
+    m_slot_head[slot] = invalid_idx;
+    m_occupied[0] &= ~(1ul << slot);
+
+    while (idx != invalid_idx) {
+        const auto next{m_nodes[idx].next};
+        link_expired(idx);
+        ++count;
+        idx = next;
+    }
+    return count;
+}
+
+uint64_t timer_wheel::tick_ceil(Clock::time_point t) const {
+    if (t <= m_base) { return 0; }
+    const auto ns{static_cast< uint64_t >(std::chrono::duration_cast< std::chrono::nanoseconds >(t - m_base).count())};
+    return (ns + m_tick_ns - 1) / m_tick_ns;
+}
+
+uint64_t timer_wheel::tick_floor(Clock::time_point t) const {
+    if (t <= m_base) { return 0; }
+    return static_cast< uint64_t >(std::chrono::duration_cast< std::chrono::nanoseconds >(t - m_base).count()) /
+        m_tick_ns;
+}
+} // namespace iomgr
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "iomgr_coro.hpp"
+#include "io_job.hpp"
+
+#if defined(__cpp_impl_coroutine)
+namespace iomgr {
+
+/**************** Coroutine variant of IOJob ***************/
+// Each worker runs (qdepth / num_workers) coroutine loops, each of which keeps exactly one IO outstanding. The
+// per IO request context of IOJob is replaced by the coroutine frame and the buffer is allocated once per loop.
+class CoIOJob : public IOJob {
+public:
+    CoIOJob(const std::shared_ptr< IOExaminer >& examiner, const IOJobCfg& cfg) : IOJob{examiner, cfg} {}
+
+    virtual ~CoIOJob() override = default;
+    CoIOJob(const CoIOJob&) = delete;
+    CoIOJob(CoIOJob&&) noexcept = delete;
+    CoIOJob& operator=(const CoIOJob&) = delete;
+    CoIOJob& operator=(CoIOJob&&) noexcept = delete;
+
+    void start_in_this_thread() override {
+        RELEASE_ASSERT_GE(m_cfg.qdepth, iomanager.num_workers());
+        m_status_threads_executing.set_status(job_status_t::running);
+
+        const auto nloops{m_cfg.qdepth / iomanager.num_workers()};
+        m_outstanding_ios.fetch_add(nloops, std::memory_order_acq_rel);
+        for (uint64_t i{0}; i < nloops; ++i) {
+            io_loop();
+        }
+    }
+
+    // Loops drive themselves on completion, nothing to kick off from the periodic timer
+    void run_one_iteration() override {}
+    std::string job_name() const { return "CoVolIOJob"; }
+
+private:
+    static constexpr uint64_t busy_lba_retry_ns{10 * 1000};
+
+    detached_task io_loop() {
+        uint8_t* buf{iomanager.iobuf_alloc(512, m_cfg.max_io_size)};
+
+        while (!time_to_stop()) {
+            const auto op{pick_io_type()};
+            const auto r{pick_lbas(op)};
+            if (!r.valid_io) {
+                // All candidate lbas are busy with other loops, give them a chance to complete
+                co_await sleep_for(busy_lba_retry_ns);
+                continue;
+            }
+
+            const auto& vinfo{m_examiner->m_vol_info[r.vol_idx]};
+            auto* vol_dev{vinfo->m_vol_dev.get()};
+            auto* drive{vol_dev->drive_interface()};
+            const uint32_t size{static_cast< uint32_t >(r.num_lbas * vinfo->m_page_size)};
+            const uint64_t offset{r.lba * vinfo->m_page_size};
+            const auto start_time{Clock::now()};
+
+            int64_t res{0};
+            switch (op) {
+            case io_type_t::write:
+                populate_buf(buf, size, r.lba);
+                COUNTER_INCREMENT(m_metrics, iojob_write_count, 1);
+                res = co_await co_write(drive, vol_dev, reinterpret_cast< const char* >(buf), size, offset);
+                HISTOGRAM_OBSERVE(m_metrics, iojob_write_latency, get_elapsed_time_us(start_time));
+                m_output.write_cnt.fetch_add(1, std::memory_order_relaxed);
+                if (res != 0) { m_output.write_err_cnt.fetch_add(1, std::memory_order_relaxed); }
+                break;
+            case io_type_t::read:
+                COUNTER_INCREMENT(m_metrics, iojob_read_count, 1);
+                res = co_await co_read(drive, vol_dev, reinterpret_cast< char* >(buf), size, offset);
+                HISTOGRAM_OBSERVE(m_metrics, iojob_read_latency, get_elapsed_time_us(start_time));
+                m_output.read_cnt.fetch_add(1, std::memory_order_relaxed);
+                if (res != 0) { m_output.read_err_cnt.fetch_add(1, std::memory_order_relaxed); }
+                break;
+            case io_type_t::unmap:
+                COUNTER_INCREMENT(m_metrics, iojob_unmap_count, 1);
+                res = co_await co_unmap(drive, vol_dev, size, offset);
+                HISTOGRAM_OBSERVE(m_metrics, iojob_unmap_latency, get_elapsed_time_us(start_time));
+                m_output.unmap_cnt.fetch_add(1, std::memory_order_relaxed);
+                if (res != 0) { m_output.unmap_err_cnt.fetch_add(1, std::memory_order_relaxed); }
+                break;
+            }
+
+            {
+                std::unique_lock< std::mutex > lk(vinfo->m_mtx);
+                vinfo->mark_lbas_free(r.lba, r.num_lbas);
+            }
+        }
+
+        iomanager.iobuf_free(buf);
+        m_outstanding_ios.fetch_sub(1, std::memory_order_acq_rel);
+        notify_completions();
+    }
+
+    io_lba_range_t pick_lbas(const io_type_t op) {
+        if (m_cfg.load_type == load_type_t::same) { return same_lbas(); }
+        if ((m_cfg.load_type == load_type_t::sequential) && (op == io_type_t::write)) { return seq_lbas(); }
+
+        switch (op) {
+        case io_type_t::write:
+            return writeable_rand_lbas();
+        case io_type_t::read:
+            return readable_rand_lbas();
+        case io_type_t::unmap:
+        default:
+            return unmappable_rand_lbas();
+        }
+    }
+};
+} // namespace iomgr
+#endif
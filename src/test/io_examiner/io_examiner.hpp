@@ -18,6 +18,7 @@ private:
     friend class IOExaminer;
     friend class Job;
     friend class IOJob;
+    friend class CoIOJob;
 
     io_device_ptr m_vol_dev;
     std::string m_vol_name;
@@ -68,6 +69,7 @@ public:
 class IOExaminer {
     friend class Job;
     friend class IOJob;
+    friend class CoIOJob;
 
 protected:
     std::atomic< size_t > m_outstanding_ios;
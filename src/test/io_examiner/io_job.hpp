@@ -4,6 +4,9 @@
 #include <map>
 #include <random>
 #include <chrono>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 
 #include <sisl/fds/bitset.hpp>
 #include <sisl/logging/logging.h>
@@ -26,9 +29,19 @@ ENUM(verify_type_t, uint8_t, csum, data, header, null);
 ENUM(load_type_t, uint8_t, random, same, sequential);
 VENUM(io_type_t, uint8_t, write = 0, read = 1, unmap = 2);
 ENUM(buf_pattern_t, uint8_t, random, lbas);
+ENUM(commit_type_t, uint8_t, none, fsync, durable); // How a write is made durable before its completion
 
 using Clock = std::chrono::steady_clock;
 
+// Cycle counter to measure the submission cost of an io, nanoseconds where tsc is not available
+static inline uint64_t cpu_cycles() {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(Clock::now().time_since_epoch()).count();
+#endif
+}
+
 struct IOJobCfg : public JobCfg {
 public:
     IOJobCfg() = default;
@@ -54,6 +67,8 @@ public:
     load_type_t load_type{load_type_t::random};     // IO type (random, sequential, same)
     buf_pattern_t buf_pattern{buf_pattern_t::lbas}; // Buffer pattern to read/write verify (fill with lba, random)
     std::optional< uint32_t > io_blk_size;          // If not provided, use random blk_size, else use this blksize
+    commit_type_t commit_type{commit_type_t::none}; // Write latency then covers the fsync/durable write as well
+    bool embedded_iocb{false}; // Submit read/write on the iocb embedded in the request (async_io), instead of async_*
 
     // Distribution of IO Patterms
     std::map< io_type_t, float > io_dist{{io_type_t::write, 34}, {io_type_t::read, 33}, {io_type_t::unmap, 33}};
@@ -86,6 +101,8 @@ public:
     std::atomic< uint64_t > read_cnt = 0;
     std::atomic< uint64_t > unmap_cnt = 0;
     std::atomic< uint64_t > read_err_cnt = 0;
+    std::atomic< uint64_t > write_err_cnt = 0;
+    std::atomic< uint64_t > unmap_err_cnt = 0;
     std::atomic< uint64_t > vol_create_cnt = 0;
     std::atomic< uint64_t > vol_del_cnt = 0;
     std::atomic< uint64_t > vol_mounted_cnt = 0;
@@ -102,6 +119,8 @@ public:
         if ((v = read_cnt.load())) fmt::format_to(fmt::appender(buf), "read_cnt={} ", v);
         if ((v = unmap_cnt.load())) fmt::format_to(fmt::appender(buf), "unmap_cnt={} ", v);
         if ((v = read_err_cnt.load())) fmt::format_to(fmt::appender(buf), "read_err_cnt={} ", v);
+        if ((v = write_err_cnt.load())) fmt::format_to(fmt::appender(buf), "write_err_cnt={} ", v);
+        if ((v = unmap_err_cnt.load())) fmt::format_to(fmt::appender(buf), "unmap_err_cnt={} ", v);
         if ((v = data_match_cnt.load())) fmt::format_to(fmt::appender(buf), "data_match_cnt={} ", v);
         if ((v = csum_match_cnt.load())) fmt::format_to(fmt::appender(buf), "csum_match_cnt={} ", v);
         if ((v = hdr_only_match_cnt.load())) fmt::format_to(fmt::appender(buf), "hdr_only_match_cnt={} ", v);
@@ -135,6 +154,7 @@ public:
         REGISTER_HISTOGRAM(iojob_read_latency, "Read latency");
         REGISTER_HISTOGRAM(iojob_write_latency, "Write latency");
         REGISTER_HISTOGRAM(iojob_unmap_latency, "Unmap latency");
+        REGISTER_HISTOGRAM(iojob_submit_cycles, "Cycles taken by the drive interface to submit a read/write");
 
         register_me_to_farm();
     }
@@ -190,6 +210,7 @@ public:
     bool is_async_job() const override { return true; }
     std::string job_name() const { return "VolIOJob"; }
     std::string job_result() const { return sisl::MetricsFarm::getInstance().get_result_in_json().dump(2); }
+    uint64_t io_count() const { return m_output.io_count(); }
 
 protected:
     IOJobCfg m_cfg;
@@ -199,7 +220,7 @@ protected:
     std::atomic< int64_t > m_outstanding_ios{0};
     std::discrete_distribution<> m_io_picker;
 
-private:
+protected:
     struct io_lba_range_t {
         io_lba_range_t() {}
         io_lba_range_t(bool valid, uint64_t vidx, uint64_t l, uint32_t n) :
@@ -223,6 +244,8 @@ private:
         std::shared_ptr< vol_info_t > vol_info;
         Clock::time_point start_time;
         bool done{false};
+        bool fsync_issued{false};
+        drive_iocb iocb; // Used only if embedded_iocb is set
 
         ~io_req_t() {
             if (buffer) { iomanager.iobuf_free(buffer); }
@@ -230,7 +253,7 @@ private:
         }
     };
 
-private:
+protected:
     std::shared_ptr< vol_info_t > pick_vol_round_robin(io_lba_range_t& r) {
         r.vol_idx = ++m_cur_vol % m_examiner->m_vol_info.size();
         auto vinfo = m_examiner->m_vol_info[r.vol_idx];
@@ -269,6 +292,9 @@ private:
         std::uniform_int_distribution< uint64_t > lba_random{0, vinfo->m_max_vol_blks - max_blks - 1};
         // nlbas: [1, max_blks]
         std::uniform_int_distribution< uint32_t > nlbas_random{1, max_blks};
+        const auto pick_nlbas{[&]() -> uint32_t {
+            return m_cfg.io_blk_size ? *m_cfg.io_blk_size / vinfo->m_page_size : nlbas_random(engine);
+        }};
 
         // we won't be writing more then 128 blocks in one io
         uint32_t attempt{1};
@@ -277,13 +303,13 @@ private:
             std::unique_lock< std::mutex > lk{vinfo->m_mtx};
             if (lba_choice == lbas_choice_t::dont_care) {
                 ret.lba = lba_random(engine);
-                ret.num_lbas = nlbas_random(engine);
+                ret.num_lbas = pick_nlbas();
             } else {
                 const auto start_lba = (attempt++ == 1u) ? lba_random(engine) : 0;
                 std::tie(ret.lba, ret.num_lbas) = vinfo->get_next_valid_lbas(
-                    start_lba, 1u, (lba_choice == lbas_choice_t::all_valid) ? nlbas_random(engine) : 1u);
+                    start_lba, 1u, (lba_choice == lbas_choice_t::all_valid) ? pick_nlbas() : 1u);
                 if ((lba_choice == lbas_choice_t::atleast_one_valid) && (ret.num_lbas)) {
-                    ret.num_lbas = nlbas_random(engine);
+                    ret.num_lbas = pick_nlbas();
                     std::uniform_int_distribution< uint32_t > pivot_random{0, ret.num_lbas - 1};
                     const auto pivot{pivot_random(engine)};
                     ret.lba = (ret.lba < pivot) ? 0 : ret.lba - pivot;
@@ -399,8 +425,23 @@ private:
         COUNTER_INCREMENT(m_metrics, iojob_write_count, 1);
         req->start_time = Clock::now();
         auto& vol_dev = req->vol_info->m_vol_dev;
-        vol_dev->drive_interface()->async_write(vol_dev.get(), reinterpret_cast< const char* >(req->buffer), size,
-                                                lba * req->vol_info->m_page_size, reinterpret_cast< uint8_t* >(req));
+        const auto submit_start{cpu_cycles()};
+        if (m_cfg.embedded_iocb) {
+            req->iocb.prepare(vol_dev.get(), DriveOpType::WRITE, size, lba * req->vol_info->m_page_size, req);
+            req->iocb.set_data(reinterpret_cast< char* >(req->buffer));
+            req->iocb.durable = (m_cfg.commit_type == commit_type_t::durable);
+            vol_dev->drive_interface()->async_io(&req->iocb);
+        } else if (m_cfg.commit_type == commit_type_t::durable) {
+            const iovec iov{req->buffer, size};
+            vol_dev->drive_interface()->async_writev_durable(vol_dev.get(), &iov, 1, size,
+                                                             lba * req->vol_info->m_page_size,
+                                                             reinterpret_cast< uint8_t* >(req));
+        } else {
+            vol_dev->drive_interface()->async_write(vol_dev.get(), reinterpret_cast< const char* >(req->buffer), size,
+                                                    lba * req->vol_info->m_page_size,
+                                                    reinterpret_cast< uint8_t* >(req));
+        }
+        HISTOGRAM_OBSERVE(m_metrics, iojob_submit_cycles, cpu_cycles() - submit_start);
         m_outstanding_ios.fetch_add(1, std::memory_order_acq_rel);
         return true;
     }
@@ -420,8 +461,16 @@ private:
         COUNTER_INCREMENT(m_metrics, iojob_read_count, 1);
         req->start_time = Clock::now();
         auto& vol_dev = req->vol_info->m_vol_dev;
-        vol_dev->drive_interface()->async_read(vol_dev.get(), reinterpret_cast< char* >(req->buffer), size,
-                                               lba * req->vol_info->m_page_size, reinterpret_cast< uint8_t* >(req));
+        const auto submit_start{cpu_cycles()};
+        if (m_cfg.embedded_iocb) {
+            req->iocb.prepare(vol_dev.get(), DriveOpType::READ, size, lba * req->vol_info->m_page_size, req);
+            req->iocb.set_data(reinterpret_cast< char* >(req->buffer));
+            vol_dev->drive_interface()->async_io(&req->iocb);
+        } else {
+            vol_dev->drive_interface()->async_read(vol_dev.get(), reinterpret_cast< char* >(req->buffer), size,
+                                                   lba * req->vol_info->m_page_size, reinterpret_cast< uint8_t* >(req));
+        }
+        HISTOGRAM_OBSERVE(m_metrics, iojob_submit_cycles, cpu_cycles() - submit_start);
         m_outstanding_ios.fetch_add(1, std::memory_order_acq_rel);
         m_output.read_cnt.fetch_add(1, std::memory_order_relaxed);
         return true;
@@ -448,6 +497,14 @@ private:
 
     void on_completion(int64_t res, uint8_t* cookie) {
         io_req_t* req = reinterpret_cast< io_req_t* >(cookie);
+        if ((req->op_type == io_type_t::write) && (m_cfg.commit_type == commit_type_t::fsync) && !req->fsync_issued) {
+            // Write is committed only after the fsync which follows its completion
+            req->fsync_issued = true;
+            auto& vol_dev = req->vol_info->m_vol_dev;
+            vol_dev->drive_interface()->fsync(vol_dev.get(), cookie);
+            return;
+        }
+
         if (req->op_type == io_type_t::read) {
             HISTOGRAM_OBSERVE(m_metrics, iojob_read_latency, get_elapsed_time_us(req->start_time));
         } else if (req->op_type == io_type_t::write) {
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <io_deadline_tracker.hpp>
+
+using namespace iomgr;
+
+struct test_iocb {
+    uint64_t id;
+    io_deadline_hook< test_iocb > deadline_hook;
+};
+
+TEST(IODeadlineTrackerTest, expiry) {
+    static constexpr uint64_t num_ios{1000};
+    const auto base{std::chrono::steady_clock::now() - std::chrono::seconds(10)};
+    std::vector< test_iocb > iocbs(num_ios);
+    io_deadline_tracker< test_iocb > tracker;
+
+    // One io submitted every ms, odd ones complete right away
+    for (uint64_t i{0}; i < num_ios; ++i) {
+        iocbs[i].id = i;
+        tracker.add(&iocbs[i], base + std::chrono::milliseconds(i));
+    }
+    for (uint64_t i{1}; i < num_ios; i += 2) {
+        ASSERT_EQ(tracker.remove(&iocbs[i]), 0) << "Completion of an io which is not timed out is reported as stuck";
+    }
+    ASSERT_EQ(tracker.size(), num_ios / 2);
+
+    // Ios submitted upto the cutoff expire, oldest first and only once
+    const auto cutoff{base + std::chrono::milliseconds(num_ios / 2)};
+    uint64_t expired{0};
+    while (auto* io = tracker.pop_expired(cutoff)) {
+        ASSERT_EQ(io->id, expired * 2) << "Ios not expired in the order of deadline";
+        ASSERT_TRUE(io->deadline_hook.timed_out);
+        ++expired;
+    }
+    ASSERT_EQ(expired, (num_ios / 4) + 1);
+    ASSERT_EQ(tracker.pop_expired(cutoff), nullptr) << "Expired io reported again";
+
+    // Expired ios still count as outstanding until they complete, when they report how long they were stuck
+    ASSERT_EQ(tracker.size(), num_ios / 2);
+    ASSERT_GE(tracker.remove(&iocbs[0]), 10 * 1000);
+    ASSERT_FALSE(iocbs[0].deadline_hook.linked);
+    ASSERT_EQ(tracker.remove(&iocbs[0]), 0) << "Double remove should be a no-op";
+    for (uint64_t i{2}; i < num_ios; i += 2) {
+        tracker.remove(&iocbs[i]);
+    }
+    ASSERT_TRUE(tracker.empty());
+    ASSERT_EQ(tracker.pop_expired(std::chrono::steady_clock::now()), nullptr);
+}
+
+/* NOTE: Make sure this is the last test case, so that iomanager stop is running in parallel to timer test */
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,11 +1,16 @@
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
+#include <future>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef __linux__
 #include <fcntl.h>
+#include <sys/resource.h>
 #endif
 
 #include <sisl/logging/logging.h>
@@ -16,6 +21,7 @@
 #include <iomgr.hpp>
 
 #include "io_examiner/io_job.hpp"
+#include "io_examiner/co_io_job.hpp"
 
 using namespace iomgr;
 SISL_LOGGING_INIT(IOMGR_LOG_MODS, flip)
@@ -28,15 +34,18 @@ SISL_OPTION_GROUP(test_io,
                   (device_list, "", "device_list", "List of device paths",
                    ::cxxopts::value< std::vector< std::string > >(), "path [...]"),
                   (device_size, "", "device_size", "size of devices to do IO on",
-                   ::cxxopts::value< uint64_t >()->default_value("1073741824"), "size"))
+                   ::cxxopts::value< uint64_t >()->default_value("1073741824"), "size"),
+                  (io_size, "", "io_size", "size of each io of basic_io_test, random sizes if not provided",
+                   ::cxxopts::value< uint32_t >(), "size"),
+                  (embedded_iocb, "", "embedded_iocb", "Submit ios of basic_io_test on the iocb embedded in request",
+                   ::cxxopts::value< bool >()->default_value("false"), "true or false"),
+                  (commit_type, "", "commit_type", "commit path to measure by commit_latency_test - fsync or durable",
+                   ::cxxopts::value< std::string >(), "type"))
 
 #define ENABLED_OPTIONS logging, iomgr, test_io, config
 SISL_OPTIONS_ENABLE(ENABLED_OPTIONS)
 
-TEST(IOMgrTest, basic_io_test) {
-    const auto nthreads{SISL_OPTIONS["num_threads"].as< uint32_t >()};
-    const auto examiner{std::make_shared< iomgr::IOExaminer >(nthreads, false /* integrated mode */)};
-
+static uint64_t add_test_devices(const std::shared_ptr< iomgr::IOExaminer >& examiner) {
     // Create an add the device
     std::vector< std::string > devs{"/tmp/io_test"}; // Default if user has not provided
     if (SISL_OPTIONS.count("device_list")) { devs = SISL_OPTIONS["device_list"].as< std::vector< std::string > >(); }
@@ -52,11 +61,53 @@ TEST(IOMgrTest, basic_io_test) {
         std::filesystem::resize_file(file_path, dev_size);
         examiner->add_device(dev, O_RDWR);
     }
+    return dev_size;
+}
+
+TEST(IOMgrTest, basic_io_test) {
+    const auto nthreads{SISL_OPTIONS["num_threads"].as< uint32_t >()};
+    const auto examiner{std::make_shared< iomgr::IOExaminer >(nthreads, false /* integrated mode */)};
+    const auto dev_size{add_test_devices(examiner)};
 
     IOJobCfg cfg;
     cfg.max_disk_capacity = dev_size;
     cfg.run_time = SISL_OPTIONS["run_time"].as< uint32_t >();
     cfg.io_dist = {{io_type_t::write, 50}, {io_type_t::read, 50}};
+    if (SISL_OPTIONS.count("io_size")) { cfg.io_blk_size = SISL_OPTIONS["io_size"].as< uint32_t >(); }
+    cfg.embedded_iocb = SISL_OPTIONS["embedded_iocb"].as< bool >();
+
+    IOJob job(examiner, cfg);
+    const auto start{std::chrono::steady_clock::now()};
+    job.start_job(wait_till_t::completion);
+    const std::chrono::duration< double > elapsed{std::chrono::steady_clock::now() - start};
+
+    LOGINFO("Result: {}", job.job_result());
+    LOGINFO("IOPS: {:.0f} ({} ios in {:.2f} secs)", job.io_count() / elapsed.count(), job.io_count(), elapsed.count());
+#ifdef __linux__
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) { LOGINFO("Max RSS of the process: {} KB", usage.ru_maxrss); }
+#endif
+}
+
+// Write latency of small writes made durable either by fsync after the write or by a single durable write
+TEST(IOMgrTest, commit_latency_test) {
+    if (!SISL_OPTIONS.count("commit_type")) {
+        LOGINFO("commit_type is not provided, skipping commit path latency test");
+        return;
+    }
+    const auto nthreads{SISL_OPTIONS["num_threads"].as< uint32_t >()};
+    const auto examiner{std::make_shared< iomgr::IOExaminer >(nthreads, false /* integrated mode */)};
+    const auto dev_size{add_test_devices(examiner)};
+
+    IOJobCfg cfg;
+    cfg.max_disk_capacity = dev_size;
+    cfg.run_time = SISL_OPTIONS["run_time"].as< uint32_t >();
+    cfg.io_dist = {{io_type_t::write, 100}};
+    cfg.load_type = load_type_t::sequential;
+    cfg.io_blk_size = 4096;
+    cfg.qdepth = nthreads; // One outstanding commit per thread, as a journal would do
+    cfg.commit_type = (SISL_OPTIONS["commit_type"].as< std::string >() == "durable") ? commit_type_t::durable
+                                                                                       : commit_type_t::fsync;
 
     IOJob job(examiner, cfg);
     job.start_job(wait_till_t::completion);
@@ -64,6 +115,98 @@ TEST(IOMgrTest, basic_io_test) {
     LOGINFO("Result: {}", job.job_result());
 }
 
+#if defined(__cpp_impl_coroutine)
+TEST(IOMgrTest, coroutine_io_test) {
+    const auto nthreads{SISL_OPTIONS["num_threads"].as< uint32_t >()};
+    const auto examiner{std::make_shared< iomgr::IOExaminer >(nthreads, false /* integrated mode */)};
+    const auto dev_size{add_test_devices(examiner)};
+
+    IOJobCfg cfg;
+    cfg.max_disk_capacity = dev_size;
+    cfg.run_time = SISL_OPTIONS["run_time"].as< uint32_t >();
+    cfg.io_dist = {{io_type_t::write, 50}, {io_type_t::read, 50}};
+
+    CoIOJob job(examiner, cfg);
+    job.start_job(wait_till_t::completion);
+
+    LOGINFO("Result: {}", job.job_result());
+}
+
+struct run_on_await_result {
+    bool ran{false};
+    bool ran_on_dest{false};
+    bool resumed_on_caller{false};
+    bool ran_on_stopped{true};
+    bool method_called_on_stopped{true};
+    bool resumed_after_stopped{false};
+};
+
+static detached_task await_run_on(io_thread_t dest, io_thread_t stopped, std::promise< run_on_await_result >* done) {
+    run_on_await_result r;
+    const auto caller{iomanager.iothread_self()};
+
+    // Method runs on the destination thread and the coroutine resumes back on this thread
+    r.ran = co_await run_on_await(dest, [&r, &dest]() { r.ran_on_dest = (iomanager.iothread_self() == dest); });
+    r.resumed_on_caller = (iomanager.iothread_self() == caller);
+
+    // Method can't be sent to a thread which stopped its io loop, coroutine goes on right away without running it
+    r.method_called_on_stopped = false;
+    r.ran_on_stopped = co_await run_on_await(stopped, [&r]() { r.method_called_on_stopped = true; });
+    r.resumed_after_stopped = (iomanager.iothread_self() == caller);
+
+    done->set_value(r);
+}
+
+TEST(IOMgrTest, coroutine_run_on_test) {
+    iomanager.start(2 /* num_threads */);
+
+    std::mutex mtx;
+    std::vector< io_thread_t > workers;
+    iomanager.run_on(
+        thread_regex::all_worker,
+        [&]([[maybe_unused]] auto taddr) {
+            std::unique_lock< std::mutex > lk{mtx};
+            workers.push_back(iomanager.iothread_self());
+        },
+        wait_type_t::sleep);
+    ASSERT_EQ(workers.size(), 2u);
+
+    // User reactor which stops its io loop right after starting it, but whose thread stays around till the end
+    io_thread_t stopped_thread;
+    std::promise< void > stopped;
+    std::promise< void > may_exit;
+    std::thread user_thread{[&]() {
+        iomanager.run_io_loop(INTERRUPT_LOOP, nullptr, [&](bool is_started) {
+            if (is_started) {
+                stopped_thread = iomanager.iothread_self();
+                iomanager.stop_io_loop();
+            }
+        });
+        stopped.set_value();
+        may_exit.get_future().wait();
+    }};
+    stopped.get_future().wait();
+
+    std::promise< run_on_await_result > done;
+    auto result{done.get_future()};
+    iomanager.run_on(workers[0], [&workers, &stopped_thread, &done]([[maybe_unused]] auto taddr) {
+        await_run_on(workers[1], stopped_thread, &done);
+    });
+    const auto r{result.get()};
+
+    EXPECT_TRUE(r.ran) << "co_await run_on_await didn't report the method as run";
+    EXPECT_TRUE(r.ran_on_dest) << "Method was not run on the destination thread";
+    EXPECT_TRUE(r.resumed_on_caller) << "Coroutine didn't resume on the awaiting thread";
+    EXPECT_FALSE(r.ran_on_stopped) << "co_await run_on_await reported the method as run on a stopped thread";
+    EXPECT_FALSE(r.method_called_on_stopped) << "Method was run on a stopped thread";
+    EXPECT_TRUE(r.resumed_after_stopped) << "Coroutine didn't go on on the awaiting thread";
+
+    may_exit.set_value();
+    user_thread.join();
+    iomanager.stop();
+}
+#endif
+
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     SISL_OPTIONS_LOAD(argc, argv, ENABLED_OPTIONS);
@@ -0,0 +1,48 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <iobuf_arena.hpp>
+
+using namespace iomgr;
+
+TEST(IOBufArenaTest, alloc_free) {
+    iobuf_arena arena{8 * 1024 * 1024};
+    ASSERT_EQ(arena.size(), 8ul * 1024 * 1024);
+    ASSERT_EQ(reinterpret_cast< uintptr_t >(arena.iov().iov_base) % iobuf_arena::chunk_size, 0ul);
+
+    // Rounded up to the size class and aligned to it
+    auto* b1{arena.alloc(512, 4096)};
+    ASSERT_TRUE((b1 != nullptr) && arena.owns(b1));
+    ASSERT_EQ(arena.buf_size(b1), 4096ul);
+    auto* b2{arena.alloc(4096, 5000)};
+    ASSERT_NE(b2, nullptr);
+    ASSERT_EQ(arena.buf_size(b2), 8192ul);
+    ASSERT_EQ(reinterpret_cast< uintptr_t >(b2) % 8192, 0ul);
+    ASSERT_EQ(arena.alloc(4096, 2 * iobuf_arena::max_buf_size), nullptr);
+
+    // Freed buffer is reused first
+    arena.free(b1);
+    ASSERT_EQ(arena.alloc(4096, 100), b1);
+    arena.free(b1);
+    arena.free(b2);
+
+    // Two chunks are taken by 4K and 8K classes, rest can hold 4 buffers of 1M
+    std::vector< uint8_t* > bufs;
+    while (auto* b = arena.alloc(4096, iobuf_arena::max_buf_size)) {
+        bufs.push_back(b);
+    }
+    ASSERT_EQ(bufs.size(), 4ul);
+    for (auto* b : bufs) {
+        arena.free(b);
+    }
+    ASSERT_EQ(arena.alloc(4096, iobuf_arena::max_buf_size), bufs.back());
+
+    uint8_t local;
+    ASSERT_FALSE(arena.owns(&local));
+}
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
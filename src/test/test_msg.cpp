@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <array>
+#include <cstdlib>
+#include <new>
 #include <vector>
 #include <chrono>
 #include <mutex>
@@ -20,6 +23,10 @@ SISL_OPTION_GROUP(test_msg,
                    ::cxxopts::value< uint32_t >()->default_value("8"), "number"),
                   (client_threads, "", "client_threads", "client_threads",
                    ::cxxopts::value< uint32_t >()->default_value("2"), "number"),
+                  (fanin_threads, "", "fanin_threads", "Number of sender threads for many to one benchmark",
+                   ::cxxopts::value< uint32_t >()->default_value("16"), "number"),
+                  (batch_size, "", "batch_size", "Number of closures per batch for batched send benchmark",
+                   ::cxxopts::value< uint32_t >()->default_value("64"), "number"),
                   (iters, "", "iters", "iters", ::cxxopts::value< uint64_t >()->default_value("10000"), "number"),
                   (spdk, "", "spdk", "spdk", ::cxxopts::value< bool >()->default_value("false"), "true or false"))
 
@@ -39,15 +46,32 @@ struct timer_test_info {
 
 static uint32_t g_io_threads{0};
 static uint32_t g_client_threads{0};
+static uint32_t g_fanin_threads{0};
+static uint32_t g_batch_size{0};
 static bool g_is_spdk{false};
 static uint64_t g_iters{0};
+static std::atomic< uint64_t > g_heap_alloc_count{0};
+static thread_local bool t_count_heap_allocs{false};
 // static std::vector< std::unique_ptr< timer_test_info > > g_timer_infos;
 
+// Count the heap allocations of only the threads which enabled it (see MsgTest::count_heap_allocs), so that the
+// benchmarks report allocations per message without the traffic of unrelated threads (timers, metrics etc..).
+// Messages themselves don't come through here, but from msg_pool which counts its own system allocations.
+void* operator new(size_t size) {
+    if (t_count_heap_allocs) { g_heap_alloc_count.fetch_add(1, std::memory_order_relaxed); }
+    if (void* p = std::malloc(size)) { return p; }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
 void glob_setup() {
     g_is_spdk = SISL_OPTIONS["spdk"].as< bool >();
     g_io_threads = SISL_OPTIONS["io_threads"].as< uint32_t >();
     if ((SISL_OPTIONS.count("io_threads") == 0) && g_is_spdk) { g_io_threads = 2; }
     g_client_threads = SISL_OPTIONS["client_threads"].as< uint32_t >();
+    g_fanin_threads = SISL_OPTIONS["fanin_threads"].as< uint32_t >();
+    g_batch_size = SISL_OPTIONS["batch_size"].as< uint32_t >();
     g_iters = SISL_OPTIONS["iters"].as< uint64_t >();
 
     ioenvironment.with_iomgr(g_io_threads, g_is_spdk);
@@ -108,9 +132,10 @@ public:
         ASSERT_EQ(m_sent_count, m_rcvd_count) << "Missing messages";
     }
 
-    void async_msg_test(const thread_specifier& to_threads, const run_method_t& receiver) {
+    void async_msg_test(const thread_specifier& to_threads, const run_method_t& receiver,
+                        const uint32_t num_senders = g_client_threads) {
         std::vector< std::thread > ts;
-        for (uint32_t i{0}; i < g_client_threads; ++i) {
+        for (uint32_t i{0}; i < num_senders; ++i) {
             ts.push_back(std::move(sisl::thread_factory("test_thread", &MsgTest::msg_sender_thread, this,
                                                         wait_type_t::no_wait, to_threads, receiver)));
         }
@@ -131,6 +156,69 @@ public:
         }
     }
 
+    void wait_for_all_msgs() {
+        const auto max_wait_time{10000ms};
+        const auto check_freq{1ms};
+        auto waited_time{0ms};
+        while (m_sent_count != m_rcvd_count) {
+            ASSERT_LT(waited_time, max_wait_time)
+                << max_wait_time.count() << " ms have passed and messages are not delivered yet, sent_count="
+                << m_sent_count << " rcvd_count=" << m_rcvd_count;
+            std::this_thread::sleep_for(check_freq);
+            waited_time += check_freq;
+        }
+    }
+
+    static io_thread_t pick_worker_thread() {
+        io_thread_t target;
+        iomanager.run_on(
+            thread_regex::least_busy_worker,
+            [&target]([[maybe_unused]] auto taddr) { target = iomanager.iothread_self(); }, wait_type_t::sleep);
+        return target;
+    }
+
+    // Enable or disable counting heap allocations on this (sender) thread and the receiver threads. Allocations of
+    // the msg which toggles it on receivers are not counted on this thread.
+    static void count_heap_allocs(const thread_specifier& receivers, const bool enable) {
+        const auto toggle = [enable]([[maybe_unused]] auto taddr) { t_count_heap_allocs = enable; };
+        if (!enable) { t_count_heap_allocs = false; }
+        if (std::holds_alternative< io_thread_t >(receivers)) {
+            iomanager.run_on(std::get< io_thread_t >(receivers), toggle, wait_type_t::sleep);
+        } else if (std::holds_alternative< thread_regex >(receivers)) {
+            iomanager.run_on(std::get< thread_regex >(receivers), toggle, wait_type_t::sleep);
+        }
+        if (enable) { t_count_heap_allocs = true; }
+    }
+
+    // Doorbells rung by senders to wake up the given thread so far
+    static uint64_t doorbell_count(const io_thread_t& thr) {
+        uint64_t count{0};
+        iomanager.run_on(
+            thr, [&count]([[maybe_unused]] auto taddr) { count = iomanager.this_thread_metrics().msg_doorbell_count; },
+            wait_type_t::sleep);
+        return count;
+    }
+
+    // Heap allocations so far by the threads counting it, plus the msgs which were not served from the msg pool
+    static uint64_t heap_alloc_count() {
+        return g_heap_alloc_count.load() + msg_pool< iomgr_msg >::system_alloc_count();
+    }
+
+    // Send the msgs once without counting, so that the msg pool of this thread holds as many msgs as the test keeps
+    // in flight and only the steady state allocations are counted
+    void warmup_msg_pool(const thread_specifier& to_threads, const run_method_t& receiver) {
+        msg_sender_thread(wait_type_t::no_wait, to_threads, receiver);
+        wait_for_all_msgs();
+        m_sent_count = 0;
+        m_rcvd_count = 0;
+    }
+
+    static constexpr double max_heap_allocs_per_msg{0.1};
+
+    // Without coalescing, every message put while the reactor is not handling messages rings a doorbell of its own,
+    // which under a fan-in load is close to one per message
+    static constexpr double max_doorbells_per_msg{0.5};
+
     static const uint64_t early_tolerance_ns = 500 * 1000;
     static const uint64_t late_tolerance_ns = 4 * 1000 * 1000;
 
@@ -192,6 +280,15 @@ TEST_F(MsgTest, async_broadcast_msg) {
     async_msg_test(thread_regex::all_io, sink);
 }
 
+TEST_F(MsgTest, sync_broadcast_mutable_closure) {
+    // Mutable closure carries a state, so every thread is expected to run a copy of its own instead of a shared one
+    auto sink = [this, calls = uint64_t{0}]([[maybe_unused]] auto taddr) mutable {
+        if (++calls == 1) { ++this->m_rcvd_count; }
+    };
+    ASSERT_FALSE(run_method_t{sink}.is_const_invocable());
+    sync_msg_test(thread_regex::all_io, sink);
+}
+
 /**************************Randomcast Msg ************************************/
 TEST_F(MsgTest, sync_randomcast_msg) {
     auto sink = [this]([[maybe_unused]] auto taddr) { ++this->m_rcvd_count; };
@@ -258,6 +355,190 @@ TEST_F(MsgTest, async_relay_multicast_msg) {
     async_msg_test(thread_regex::least_busy_io, relay); // Send it to one thread which broadcast to all io threads
 }
 
+/**************************Many to one Msg throughput ************************/
+TEST_F(MsgTest, async_many_to_one_throughput) {
+    const auto target{pick_worker_thread()};
+    auto sink = [this]([[maybe_unused]] auto taddr) { ++this->m_rcvd_count; };
+    const auto start_doorbells{doorbell_count(target)};
+    const auto start_time{Clock::now()};
+    async_msg_test(target, sink, g_fanin_threads);
+    const auto elapsed_ns{get_elapsed_time_ns(start_time)};
+    const auto doorbells{doorbell_count(target) - start_doorbells};
+    const auto rcvd{static_cast< uint64_t >(m_rcvd_count.load())};
+    const auto doorbells_per_msg{static_cast< double >(doorbells) / std::max(rcvd, uint64_t{1})};
+
+    LOGINFO("Many to one: {} senders delivered {} msgs to a single reactor in {} ms, throughput={} msgs/sec, "
+            "doorbells={} ({:.4f} per msg)",
+            g_fanin_threads, rcvd, elapsed_ns / (1000 * 1000),
+            (rcvd * 1000ul * 1000ul * 1000ul) / std::max(elapsed_ns, uint64_t{1}), doorbells, doorbells_per_msg);
+    ASSERT_LT(doorbells_per_msg, max_doorbells_per_msg) << "Expected the doorbells of concurrent senders to coalesce";
+}
+
+/**************************Batched vs per msg send ************************/
+TEST_F(MsgTest, async_batch_vs_single_send) {
+    const auto target{pick_worker_thread()};
+    const auto total_msgs{(g_iters / g_batch_size) * g_batch_size};
+    auto sink = [this]([[maybe_unused]] auto taddr) { ++this->m_rcvd_count; };
+
+    // Per message path: one message, enqueue and wakeup for every closure
+    auto start_time{Clock::now()};
+    for (uint64_t i{0}; i < total_msgs; ++i) {
+        m_sent_count.fetch_add(iomanager.run_on(target, sink));
+    }
+    wait_for_all_msgs();
+    const auto single_ns{get_elapsed_time_ns(start_time)};
+
+    // Batched path: one message, enqueue and wakeup for every batch_size closures
+    start_time = Clock::now();
+    for (uint64_t i{0}; i < total_msgs; i += g_batch_size) {
+        std::vector< run_method_t > fns(g_batch_size, sink);
+        const auto count{iomanager.run_on_batch(target, std::move(fns))};
+        ASSERT_EQ(count, static_cast< int >(g_batch_size)) << "Expect entire batch to be sent";
+        m_sent_count.fetch_add(count);
+    }
+    wait_for_all_msgs();
+    const auto batch_ns{get_elapsed_time_ns(start_time)};
+
+    LOGINFO("Sent {} closures to single thread: per_msg={} ns/closure, batch_of_{}={} ns/closure", total_msgs,
+            single_ns / std::max(total_msgs, uint64_t{1}), g_batch_size, batch_ns / std::max(total_msgs, uint64_t{1}));
+}
+
+/**************************Allocations per msg ************************/
+TEST_F(MsgTest, async_msg_allocations) {
+    const auto target{pick_worker_thread()};
+
+    // Capture larger than what std::function can hold without allocation, but small enough for run_method_t
+    std::array< uint64_t, 5 > payload{1, 2, 3, 4, 5};
+    auto sink = [this, payload]([[maybe_unused]] auto taddr) {
+        (void)payload;
+        ++this->m_rcvd_count;
+    };
+    static_assert(run_method_t::fits_inline< decltype(sink) >, "Expect the sink closure to be stored inline");
+    ASSERT_TRUE(run_method_t{sink}.is_inline());
+
+    // Oversized captures are still accepted, but fall back to heap
+    std::array< uint64_t, 32 > big_payload{};
+    auto big_sink = [big_payload]([[maybe_unused]] auto taddr) { (void)big_payload; };
+    static_assert(!run_method_t::fits_inline< decltype(big_sink) >, "Expect the big closure to not fit inline");
+    ASSERT_FALSE(run_method_t{big_sink}.is_inline());
+
+    warmup_msg_pool(target, sink);
+    count_heap_allocs(target, true);
+    const auto start_allocs{heap_alloc_count()};
+    const auto start_time{Clock::now()};
+    for (uint64_t i{0}; i < g_iters; ++i) {
+        m_sent_count.fetch_add(iomanager.run_on(target, sink));
+    }
+    wait_for_all_msgs();
+    const auto elapsed_ns{get_elapsed_time_ns(start_time)};
+    const auto allocs{heap_alloc_count() - start_allocs};
+    count_heap_allocs(target, false);
+
+    const auto allocs_per_msg{static_cast< double >(allocs) / std::max(g_iters, uint64_t{1})};
+    LOGINFO("Sent {} msgs with {} bytes capture to single thread: {} ns/msg, {} heap allocations ({:.3f} per msg)",
+            g_iters, sizeof(sink), elapsed_ns / std::max(g_iters, uint64_t{1}), allocs, allocs_per_msg);
+    ASSERT_LT(allocs_per_msg, max_heap_allocs_per_msg) << "Expect run_on with inline closure to not heap allocate";
+}
+
+TEST_F(MsgTest, async_broadcast_allocations) {
+    auto sink = [this]([[maybe_unused]] auto taddr) { ++this->m_rcvd_count; };
+
+    // Every broadcast is expected to share a single msg across all the io threads, instead of one per thread
+    warmup_msg_pool(thread_regex::all_io, sink);
+    count_heap_allocs(thread_regex::all_io, true);
+    const auto start_allocs{heap_alloc_count()};
+    const auto start_time{Clock::now()};
+    for (uint64_t i{0}; i < g_iters; ++i) {
+        const auto count{iomanager.run_on(thread_regex::all_io, sink)};
+        ASSERT_GT(count, 0) << "Expect broadcast to be sent to atleast 1 thread";
+        m_sent_count.fetch_add(count);
+    }
+    wait_for_all_msgs();
+    const auto elapsed_ns{get_elapsed_time_ns(start_time)};
+    const auto allocs{heap_alloc_count() - start_allocs};
+    count_heap_allocs(thread_regex::all_io, false);
+
+    const auto allocs_per_broadcast{static_cast< double >(allocs) / std::max(g_iters, uint64_t{1})};
+    LOGINFO("Broadcasted {} msgs to all io threads ({} deliveries): {} ns/broadcast, {:.3f} heap allocations per "
+            "broadcast",
+            g_iters, m_sent_count.load(), elapsed_ns / std::max(g_iters, uint64_t{1}), allocs_per_broadcast);
+    ASSERT_LT(allocs_per_broadcast, max_heap_allocs_per_msg)
+        << "Expect broadcast run_on with inline closure to not heap allocate";
+}
+
+/**************************Blocking broadcast latency ************************/
+TEST_F(MsgTest, sync_broadcast_latency) {
+    auto sink = [this]([[maybe_unused]] auto taddr) { ++this->m_rcvd_count; };
+
+    uint64_t max_ns{0};
+    const auto start_time{Clock::now()};
+    for (uint64_t i{0}; i < g_iters; ++i) {
+        const auto call_start{Clock::now()};
+        const auto count{iomanager.run_on(thread_regex::all_io, sink, wait_type_t::sleep)};
+        max_ns = std::max(max_ns, get_elapsed_time_ns(call_start));
+        ASSERT_GT(count, 0) << "Expect broadcast to be sent to atleast 1 thread";
+        m_sent_count.fetch_add(count);
+        ASSERT_EQ(m_sent_count, m_rcvd_count) << "Blocking run_on returned before all threads ran the method";
+    }
+    const auto elapsed_ns{get_elapsed_time_ns(start_time)};
+
+    LOGINFO("Blocking run_on(all_io) of {} iterations: avg latency={} ns, max latency={} ns", g_iters,
+            elapsed_ns / std::max(g_iters, uint64_t{1}), max_ns);
+}
+
+/**************************Least busy worker selection ************************/
+TEST_F(MsgTest, async_least_busy_worker_policies) {
+    auto sink = [this]([[maybe_unused]] auto taddr) { ++this->m_rcvd_count; };
+    const auto saved_policy{iomanager.worker_select_policy()};
+
+    for (const auto policy : {reactor_select_policy_t::round_robin, reactor_select_policy_t::random,
+                              reactor_select_policy_t::power_of_two, reactor_select_policy_t::queue_depth}) {
+        iomanager.set_worker_select_policy(policy);
+        const auto start_time{Clock::now()};
+        async_msg_test(thread_regex::least_busy_worker, sink);
+        const auto elapsed_ns{get_elapsed_time_ns(start_time)};
+        LOGINFO("Worker select policy={}: {} senders delivered {} msgs to least busy worker in {} ns/msg",
+                enum_name(policy), g_client_threads, m_rcvd_count.load(),
+                elapsed_ns / std::max(static_cast< uint64_t >(m_rcvd_count.load()), uint64_t{1}));
+        m_sent_count.store(0);
+        m_rcvd_count.store(0);
+    }
+    iomanager.set_worker_select_policy(saved_policy);
+}
+
+/**************************Any worker (stealable) tasks ************************/
+TEST_F(MsgTest, any_worker_task_stealing) {
+    const auto owner{pick_worker_thread()};
+    std::atomic< uint64_t > stolen_count{0};
+    const auto num_tasks{std::min(g_iters, uint64_t{512})};
+
+    // Queue up all tasks locally on one worker and then keep it busy, other workers are expected to steal them. Owner
+    // stays busy till the backlog is drained (or gives up after a while), so that it doesn't run any of them itself.
+    iomanager.run_on(
+        owner,
+        [&]([[maybe_unused]] auto taddr) {
+            for (uint64_t i{0}; i < num_tasks; ++i) {
+                m_sent_count.fetch_add(iomanager.run_on_any_worker([&]([[maybe_unused]] auto taddr) {
+                    if (iomanager.iothread_self() != owner) { ++stolen_count; }
+                    ++this->m_rcvd_count;
+                }));
+            }
+
+            const auto give_up_time{Clock::now() + 5s};
+            while ((g_io_threads > 1) && (stolen_count.load() < num_tasks) && (Clock::now() < give_up_time)) {
+                std::this_thread::sleep_for(1ms);
+            }
+        },
+        wait_type_t::sleep);
+    wait_for_all_msgs();
+
+    LOGINFO("Ran {} tasks queued on one busy worker, {} of them stolen by other workers", m_rcvd_count.load(),
+            stolen_count.load());
+    if (g_io_threads > 1) {
+        ASSERT_EQ(stolen_count.load(), num_tasks) << "Expected idle workers to drain the backlog of the busy one";
+    }
+}
+
 /**************************Messages with timer ************************/
 TEST_F(MsgTest, sync_broadcast_msg_with_timer) { msg_with_timer_test(wait_type_t::sleep, thread_regex::all_io); }
 TEST_F(MsgTest, spin_broadcast_msg_with_timer) { msg_with_timer_test(wait_type_t::spin, thread_regex::all_worker); }
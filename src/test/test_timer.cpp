@@ -181,6 +181,22 @@ TEST_F(TimerTest, global_recurring_timer) {
     wait_for_all_timers();
 }
 
+TEST_F(TimerTest, thread_local_one_time_timer) {
+    iomanager.run_on(
+        thread_regex::random_worker,
+        [this]([[maybe_unused]] auto taddr) { create_random_timers(iomanager.iothread_self(), false /* recurring */); },
+        wait_type_t::sleep);
+    wait_for_all_timers();
+}
+
+TEST_F(TimerTest, thread_local_recurring_timer) {
+    iomanager.run_on(
+        thread_regex::random_worker,
+        [this]([[maybe_unused]] auto taddr) { create_random_timers(iomanager.iothread_self(), true /* recurring */); },
+        wait_type_t::sleep);
+    wait_for_all_timers();
+}
+
 /* NOTE: Make sure this is the last test case, so that iomanager stop is running in parallel to timer test */
 TEST_F(TimerTest, timer_parallel_to_shutdown) {
     std::random_device rd{};
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <boost/heap/binomial_heap.hpp>
+#include <gtest/gtest.h>
+
+#include <timer_wheel.hpp>
+
+using namespace iomgr;
+
+static constexpr uint64_t num_timers{1000};
+
+static uint64_t elapsed_ns(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector< uint64_t > random_afters(const uint64_t count) {
+    std::random_device rd{};
+    std::default_random_engine engine{rd()};
+    std::uniform_int_distribution< uint64_t > rand_freq_ns{500 * 1000, 60ul * 1000 * 1000 * 1000};
+
+    std::vector< uint64_t > afters;
+    afters.reserve(count);
+    for (uint64_t i{0}; i < count; ++i) {
+        afters.push_back(rand_freq_ns(engine));
+    }
+    return afters;
+}
+
+TEST(TimerWheelTest, schedule_cancel_expire) {
+    const auto base{std::chrono::steady_clock::now()};
+    const uint64_t count{num_timers * 100};
+    const auto afters{random_afters(count)};
+
+    // Schedule all and cancel every other one, as done for the IO timeouts which mostly get cancelled
+    uint64_t fired{0};
+    timer_wheel wheel{100 * 1000, base};
+    std::vector< timer_wheel::handle_t > hdls;
+    hdls.reserve(count);
+    for (const auto after : afters) {
+        hdls.push_back(
+            wheel.schedule(base + std::chrono::nanoseconds(after), &fired, [](void* c) { ++*(uint64_t*)c; }));
+    }
+    for (uint64_t i{0}; i < count; i += 2) {
+        ASSERT_TRUE(wheel.cancel(hdls[i]));
+    }
+    ASSERT_FALSE(wheel.cancel(hdls[0])) << "Cancel of a cancelled timer should be a no-op";
+    ASSERT_EQ(wheel.size(), count - (count / 2));
+
+    // Expire in batches till empty, only the timers which are not cancelled should be called
+    timer_wheel::expired_timer_t e;
+    auto now{base};
+    while (!wheel.empty()) {
+        now = std::max(now, *wheel.next_expiry());
+        wheel.expire(now);
+        while (wheel.pop_expired(e)) {
+            (*e.cb)(e.cookie);
+            wheel.done_expired(e);
+        }
+    }
+    ASSERT_EQ(fired, count / 2);
+    ASSERT_FALSE(wheel.cancel(hdls[1])) << "Cancel of expired timer should be a no-op";
+}
+
+TEST(TimerWheelTest, slack_coalescing) {
+    static constexpr uint64_t tick_ns{100 * 1000};
+    static constexpr uint64_t slack_ns{5 * 1000 * 1000};
+    const auto base{std::chrono::steady_clock::now()};
+    std::random_device rd{};
+    std::default_random_engine engine{rd()};
+    std::uniform_int_distribution< uint64_t > rand_after_ns{1000, 50 * 1000 * 1000};
+
+    // Run the same set of timers with and without slack and count the number of distinct expiry batches (wakeups)
+    const auto count_wakeups = [&](const std::vector< uint64_t >& afters, uint64_t slack) {
+        timer_wheel wheel{tick_ns, base};
+        for (const auto after : afters) {
+            wheel.schedule(base + std::chrono::nanoseconds(after), nullptr, [](void*) {}, 0 /* interval */, slack);
+        }
+
+        uint64_t wakeups{0};
+        timer_wheel::expired_timer_t e;
+        while (!wheel.empty()) {
+            const auto now{*wheel.next_expiry()};
+            if (wheel.expire(now)) { ++wakeups; }
+            while (wheel.pop_expired(e)) {
+                wheel.done_expired(e);
+            }
+        }
+        return wakeups;
+    };
+
+    std::vector< uint64_t > afters;
+    for (uint64_t i{0}; i < num_timers; ++i) {
+        afters.push_back(rand_after_ns(engine));
+    }
+    const auto precise_wakeups{count_wakeups(afters, 0)};
+    const auto slack_wakeups{count_wakeups(afters, slack_ns)};
+    ASSERT_LE(slack_wakeups, (50 * 1000 * 1000) / (slack_ns / 2) + 1) << "Timers within slack are not coalesced";
+    ASSERT_LE(slack_wakeups, precise_wakeups);
+
+    // Expiry with slack stays within the requested window
+    timer_wheel wheel{tick_ns, base};
+    for (const auto after : afters) {
+        const auto expiry{base + std::chrono::nanoseconds(after)};
+        const auto fire_at{*wheel.expiry_time(wheel.schedule(expiry, nullptr, [](void*) {}, 0, slack_ns))};
+        ASSERT_GE(fire_at, expiry);
+        ASSERT_LE(fire_at, expiry + std::chrono::nanoseconds(slack_ns + tick_ns));
+    }
+}
+
+TEST(TimerWheelTest, cancel_in_expiry_batch) {
+    const auto base{std::chrono::steady_clock::now()};
+    const auto expiry{base + std::chrono::milliseconds(1)};
+    timer_wheel wheel{100 * 1000, base};
+
+    // Callback of the first timer of the batch cancels the rest, which are expired along with it
+    struct batch_info {
+        timer_wheel* wheel;
+        std::vector< timer_wheel::handle_t > hdls;
+        uint64_t fired{0};
+    } info{&wheel, {}};
+    const auto cancel_others = [](void* c) {
+        auto* bi{static_cast< batch_info* >(c)};
+        if (bi->fired++ == 0) {
+            for (const auto& hdl : bi->hdls) {
+                bi->wheel->cancel(hdl);
+            }
+        }
+    };
+    for (uint32_t i{0}; i < 4; ++i) {
+        info.hdls.push_back(wheel.schedule(expiry, &info, cancel_others));
+    }
+    info.hdls.push_back(wheel.schedule(expiry, &info, cancel_others, 1000 * 1000 /* recurring */));
+
+    ASSERT_EQ(wheel.expire(expiry), info.hdls.size());
+    timer_wheel::expired_timer_t e;
+    while (wheel.pop_expired(e)) {
+        (*e.cb)(e.cookie);
+        wheel.done_expired(e);
+    }
+    ASSERT_EQ(info.fired, 1u) << "Timers cancelled by an earlier callback of the same batch are called";
+    ASSERT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, recurring_cancel_in_callback) {
+    const auto base{std::chrono::steady_clock::now()};
+    timer_wheel wheel{100 * 1000, base};
+
+    // Recurring timer cancels itself from its own callback, which is called in place from the wheel
+    struct self_cancel_info {
+        timer_wheel* wheel;
+        timer_wheel::handle_t hdl;
+        uint64_t fired{0};
+    } info{&wheel, {}};
+    info.hdl = wheel.schedule(
+        base + std::chrono::milliseconds(1), &info,
+        [](void* c) {
+            auto* si{static_cast< self_cancel_info* >(c)};
+            ++si->fired;
+            ASSERT_TRUE(si->wheel->cancel(si->hdl));
+        },
+        1000 * 1000 /* recurring */);
+
+    auto now{base};
+    timer_wheel::expired_timer_t e;
+    for (uint32_t i{0}; (i < 4) && !wheel.empty(); ++i) {
+        now = std::max(now, *wheel.next_expiry());
+        wheel.expire(now);
+        while (wheel.pop_expired(e)) {
+            (*e.cb)(e.cookie);
+            wheel.done_expired(e);
+        }
+    }
+    ASSERT_EQ(info.fired, 1u) << "Recurring timer called after it is cancelled";
+    ASSERT_TRUE(wheel.empty());
+    ASSERT_FALSE(wheel.cancel(info.hdl)) << "Handle of cancelled timer is still valid";
+}
+
+// Benchmark, not part of the unit run (run with --gtest_also_run_disabled_tests). Cost of scheduling and cancelling
+// the same timers on the locked heap used for global timers against the wheel used for thread local timers.
+TEST(TimerWheelTest, DISABLED_benchmark_wheel_vs_heap) {
+    struct heap_timer {
+        std::chrono::steady_clock::time_point expiry_time;
+        bool operator<(const heap_timer& other) const { return expiry_time > other.expiry_time; }
+    };
+
+    const auto base{std::chrono::steady_clock::now()};
+    const uint64_t count{num_timers * 1000};
+    const auto afters{random_afters(count)};
+
+    std::mutex mtx;
+    boost::heap::binomial_heap< heap_timer > heap;
+    std::vector< boost::heap::binomial_heap< heap_timer >::handle_type > heap_hdls;
+    heap_hdls.reserve(count);
+    auto start_time{std::chrono::steady_clock::now()};
+    for (const auto after : afters) {
+        std::unique_lock< std::mutex > lk{mtx};
+        heap_hdls.push_back(heap.push(heap_timer{base + std::chrono::nanoseconds(after)}));
+    }
+    for (uint64_t i{0}; i < count; i += 2) {
+        std::unique_lock< std::mutex > lk{mtx};
+        heap.erase(heap_hdls[i]);
+    }
+    const auto heap_ns{elapsed_ns(start_time)};
+
+    timer_wheel wheel{100 * 1000, base};
+    std::vector< timer_wheel::handle_t > wheel_hdls;
+    wheel_hdls.reserve(count);
+    start_time = std::chrono::steady_clock::now();
+    for (const auto after : afters) {
+        wheel_hdls.push_back(wheel.schedule(base + std::chrono::nanoseconds(after), nullptr, [](void*) {}));
+    }
+    for (uint64_t i{0}; i < count; i += 2) {
+        wheel.cancel(wheel_hdls[i]);
+    }
+    const auto wheel_ns{elapsed_ns(start_time)};
+
+    std::cout << "Schedule " << count << " and cancel " << count / 2 << " non-recurring timers: heap=" << heap_ns
+              << " ns wheel=" << wheel_ns << " ns" << std::endl;
+    ASSERT_EQ(heap.size(), wheel.size());
+}
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}